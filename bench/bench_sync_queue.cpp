@@ -0,0 +1,140 @@
+// Micro-benchmark for SyncQueue with a large offline backlog.
+//
+// Enqueues N closes plus N/2 creates (with folded and duplicate closes),
+// looks every task up, reloads the queue from disk and drains it in
+// batches. Each phase should scale linearly with N.
+//
+// Usage:
+//   ./bench_sync_queue          # 20000 operations
+//   ./bench_sync_queue 100000
+//
+// Queue files go to Qt's test-mode data directory (~/.qttest), never the
+// app's real queue.
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QUuid>
+#include <cstdio>
+
+#include "../src/models/sync_queue.h"
+
+static SyncOperation closeOperation(const QString& taskId)
+{
+    SyncOperation op;
+    op.uuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    op.type = "close_task";
+    op.taskId = taskId;
+    op.queuedAt = QDateTime::currentDateTimeUtc();
+    return op;
+}
+
+static SyncOperation createOperation(int i)
+{
+    SyncOperation op;
+    op.uuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    op.type = "create_task";
+    op.tempId = QString("temp-%1").arg(i);
+    op.taskId = op.tempId;
+    op.content = QString("Benchmark task %1").arg(i);
+    op.queuedAt = QDateTime::currentDateTimeUtc();
+    return op;
+}
+
+static void report(const char* phase, int operations, qint64 elapsedNs)
+{
+    std::printf("%-28s %8d ops %10.2f ms %8.0f ns/op\n", phase, operations,
+                elapsedNs / 1e6, operations ? double(elapsedNs) / operations : 0.0);
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("sync-queue-bench");
+    QStandardPaths::setTestModeEnabled(true);
+    QLoggingCategory::setFilterRules("*.debug=false");
+
+    int count = argc > 1 ? QString(argv[1]).toInt() : 20000;
+    if (count <= 0) {
+        std::fprintf(stderr, "usage: %s [operations]\n", argv[0]);
+        return 1;
+    }
+
+    QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QFile::remove(dataDir + "/sync_queue.cbor");
+    QFile::remove(dataDir + "/sync_queue.log");
+
+    QElapsedTimer timer;
+    int expected = 0;
+    {
+        SyncQueue queue;
+
+        // Distinct closes and creates all land in the queue
+        timer.start();
+        for (int i = 0; i < count; ++i) {
+            queue.enqueue(closeOperation(QString::number(1000000 + i)));
+        }
+        for (int i = 0; i < count / 2; ++i) {
+            queue.enqueue(createOperation(i));
+        }
+        report("enqueue", count + count / 2, timer.nsecsElapsed());
+        expected = queue.count();
+
+        // Closes of queued creates fold in; repeated closes are dropped
+        timer.start();
+        int coalesced = 0;
+        for (int i = 0; i < count / 2; ++i) {
+            coalesced += queue.enqueue(closeOperation(QString("temp-%1").arg(i))) != SyncQueue::Enqueued;
+            coalesced += queue.enqueue(closeOperation(QString::number(1000000 + i))) != SyncQueue::Enqueued;
+        }
+        report("enqueue (coalesced)", coalesced, timer.nsecsElapsed());
+
+        timer.start();
+        int found = 0;
+        for (int i = 0; i < count; ++i) {
+            found += queue.hasOperationForTask(QString::number(1000000 + i), "close_task");
+        }
+        report("hasOperationForTask", found, timer.nsecsElapsed());
+
+        timer.start();
+        queue.flush();
+        report("flush to disk", queue.count(), timer.nsecsElapsed());
+    }
+
+    // Snapshot plus log replay, as on app start
+    SyncQueue queue;
+    timer.start();
+    queue.loadFromFile();
+    report("load (replay log)", queue.count(), timer.nsecsElapsed());
+    if (queue.count() != expected) {
+        std::fprintf(stderr, "reloaded %d operations, expected %d\n", queue.count(), expected);
+        return 1;
+    }
+
+    // Retry path: bump every operation in place
+    timer.start();
+    QVector<SyncOperation> all = queue.peekBatch(queue.count());
+    for (SyncOperation op : all) {
+        ++op.retryCount;
+        queue.updateOperation(op);
+    }
+    report("updateOperation", all.size(), timer.nsecsElapsed());
+
+    // Drain in Sync API sized batches
+    timer.start();
+    int drained = 0;
+    while (!queue.isEmpty()) {
+        QStringList uuids;
+        for (const SyncOperation& op : queue.peekBatch(100)) {
+            uuids.append(op.uuid);
+        }
+        drained += queue.removeOperations(uuids);
+    }
+    report("drain (batches of 100)", drained, timer.nsecsElapsed());
+
+    queue.flush();
+    return 0;
+}
@@ -31,9 +31,13 @@ QT6_INC="/usr/include/aarch64-linux-gnu/qt6"
 
 echo "=== MOC Processing ==="
 $MOC src/models/taskmodel.h -o $OUTDIR/moc_taskmodel.cpp
+$MOC src/models/task_search_model.h -o $OUTDIR/moc_task_search_model.cpp
+$MOC src/models/task_view_model.h -o $OUTDIR/moc_task_view_model.cpp
 $MOC src/models/sync_queue.h -o $OUTDIR/moc_sync_queue.cpp
+$MOC src/models/sync_queue_writer.h -o $OUTDIR/moc_sync_queue_writer.cpp
 $MOC src/controllers/appcontroller.h -o $OUTDIR/moc_appcontroller.cpp
 $MOC src/network/todoist_client.h -o $OUTDIR/moc_todoist_client.cpp
+$MOC src/network/task_parser.h -o $OUTDIR/moc_task_parser.cpp
 $MOC src/network/sync_manager.h -o $OUTDIR/moc_sync_manager.cpp
 
 echo "=== QML Resources ==="
@@ -53,16 +57,32 @@ CXXFLAGS="-std=c++17 -fPIC -O2 \
 SOURCES="
     src/main.cpp
     src/models/task.cpp
+    src/models/string_table.cpp
     src/models/taskmodel.cpp
+    src/models/task_search_index.cpp
+    src/models/task_search_model.cpp
+    src/models/task_view_model.cpp
+    src/models/task_store.cpp
+    src/models/task_snapshot.cpp
     src/models/sync_queue.cpp
+    src/models/sync_queue_writer.cpp
+    src/models/cbor_io.cpp
     src/config/settings.cpp
     src/network/todoist_client.cpp
+    src/network/json_array_stream.cpp
+    src/network/network_error.cpp
+    src/network/token_bucket.cpp
+    src/network/task_parser.cpp
     src/network/sync_manager.cpp
     src/controllers/appcontroller.cpp
     $OUTDIR/moc_taskmodel.cpp
+    $OUTDIR/moc_task_search_model.cpp
+    $OUTDIR/moc_task_view_model.cpp
     $OUTDIR/moc_sync_queue.cpp
+    $OUTDIR/moc_sync_queue_writer.cpp
     $OUTDIR/moc_appcontroller.cpp
     $OUTDIR/moc_todoist_client.cpp
+    $OUTDIR/moc_task_parser.cpp
     $OUTDIR/moc_sync_manager.cpp
     $OUTDIR/qrc_qml.cpp
 "
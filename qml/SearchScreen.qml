@@ -0,0 +1,171 @@
+import QtQuick
+import QtQuick.Controls
+import QtQuick.Layouts
+
+Item {
+    id: searchScreen
+
+    signal closed()
+
+    // E-ink colors (match main.qml)
+    readonly property color backgroundColor: "white"
+    readonly property color textColor: "black"
+    readonly property color borderColor: "#333333"
+    readonly property color mutedColor: "#666666"
+
+    // Start every search from the full list
+    Component.onCompleted: taskSearchModel.query = ""
+    Component.onDestruction: taskSearchModel.query = ""
+
+    ColumnLayout {
+        anchors.fill: parent
+        spacing: 0
+
+        // Header (100px)
+        Rectangle {
+            Layout.fillWidth: true
+            Layout.preferredHeight: 100
+            color: backgroundColor
+            border.color: borderColor
+            border.width: 2
+
+            RowLayout {
+                anchors.fill: parent
+                anchors.margins: 20
+
+                Button {
+                    text: "Back"
+                    onClicked: closed()
+
+                    contentItem: Text {
+                        text: parent.text
+                        font.pixelSize: 24
+                        color: textColor
+                        horizontalAlignment: Text.AlignHCenter
+                        verticalAlignment: Text.AlignVCenter
+                    }
+
+                    background: Rectangle {
+                        implicitWidth: 140
+                        implicitHeight: 60
+                        color: parent.pressed ? "#e0e0e0" : backgroundColor
+                        border.color: borderColor
+                        border.width: 3
+                    }
+                }
+
+                Item { Layout.fillWidth: true }
+
+                Text {
+                    text: "Search"
+                    font.pixelSize: 36
+                    font.bold: true
+                    color: textColor
+                    Layout.alignment: Qt.AlignHCenter
+                }
+
+                Item { Layout.fillWidth: true }
+
+                Button {
+                    text: "Clear"
+                    onClicked: searchField.clear()
+
+                    contentItem: Text {
+                        text: parent.text
+                        font.pixelSize: 24
+                        color: textColor
+                        horizontalAlignment: Text.AlignHCenter
+                        verticalAlignment: Text.AlignVCenter
+                    }
+
+                    background: Rectangle {
+                        implicitWidth: 140
+                        implicitHeight: 60
+                        color: parent.pressed ? "#e0e0e0" : backgroundColor
+                        border.color: borderColor
+                        border.width: 3
+                    }
+                }
+            }
+        }
+
+        // Query field and match count
+        Rectangle {
+            Layout.fillWidth: true
+            Layout.preferredHeight: 100
+            color: backgroundColor
+            border.color: borderColor
+            border.width: 2
+
+            RowLayout {
+                anchors.fill: parent
+                anchors.margins: 20
+                spacing: 20
+
+                Rectangle {
+                    Layout.fillWidth: true
+                    Layout.preferredHeight: 60
+                    color: backgroundColor
+                    border.color: borderColor
+                    border.width: 2
+
+                    TextField {
+                        id: searchField
+                        anchors.fill: parent
+                        anchors.margins: 10
+                        font.pixelSize: 24
+                        color: textColor
+                        placeholderText: "Title or project..."
+                        background: Item {}
+
+                        // Each keystroke re-queries the search index
+                        onTextChanged: taskSearchModel.query = text
+                    }
+                }
+
+                Text {
+                    text: taskSearchModel.count + (taskSearchModel.count === 1 ? " task" : " tasks")
+                    font.pixelSize: 20
+                    color: mutedColor
+                }
+            }
+        }
+
+        // Results
+        ListView {
+            id: resultList
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            model: taskSearchModel
+            clip: true
+
+            // Touch-friendly scrolling
+            flickDeceleration: 1500
+            maximumFlickVelocity: 2000
+
+            delegate: TaskDelegate {
+                width: resultList.width
+            }
+
+            Text {
+                anchors.centerIn: parent
+                text: "No matching tasks"
+                font.pixelSize: 28
+                color: mutedColor
+                visible: resultList.count === 0 && searchField.text !== ""
+            }
+
+            ScrollBar.vertical: ScrollBar {
+                policy: ScrollBar.AsNeeded
+                width: 20
+            }
+        }
+
+        // On-screen keyboard (~350px)
+        SimpleKeyboard {
+            Layout.fillWidth: true
+            Layout.preferredHeight: 350
+            targetTextField: searchField
+        }
+    }
+}
@@ -81,39 +81,24 @@ Item {
                     Layout.fillWidth: true
                     spacing: 16
 
-                    // Project name
+                    // Project and due date, pre-formatted by the model
                     Text {
-                        text: model.projectName
+                        text: model.metadata
                         font.pixelSize: 20
                         color: mutedColor
-                        visible: model.projectName !== ""
+                        visible: text !== ""
                     }
 
                     Text {
                         text: "|"
                         font.pixelSize: 20
                         color: mutedColor
-                        visible: model.projectName !== "" && model.dueDate !== ""
-                    }
-
-                    // Due date
-                    Text {
-                        text: model.dueDate
-                        font.pixelSize: 20
-                        color: mutedColor
-                        visible: model.dueDate !== ""
-                    }
-
-                    Text {
-                        text: "|"
-                        font.pixelSize: 20
-                        color: mutedColor
-                        visible: (model.projectName !== "" || model.dueDate !== "") && model.priority > 1
+                        visible: model.metadata !== "" && model.priority > 1
                     }
 
                     // Priority
                     Text {
-                        text: "P" + model.priority
+                        text: model.priorityLabel
                         font.pixelSize: 20
                         font.bold: true
                         color: {
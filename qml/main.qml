@@ -69,6 +69,10 @@ ApplicationWindow {
                                 text: {
                                     if (!appController.syncManager) {
                                         return "..."
+                                    } else if (appController.errorMessage !== "" && taskModel.viewCounts.all > 0) {
+                                        return "Showing saved tasks"
+                                    } else if (appController.syncManager.syncError !== "") {
+                                        return appController.syncManager.syncError
                                     } else if (!appController.syncManager.isOnline) {
                                         return "Offline"
                                     } else if (appController.syncManager.pendingCount > 0) {
@@ -86,6 +90,81 @@ ApplicationWindow {
 
                         Item { Layout.fillWidth: true }
 
+                        // Cycles the smart views; counts come from the model's indexes
+                        Button {
+                            readonly property var views: ["all", "today", "overdue", "upcoming", "p1"]
+                            readonly property var labels: ["All", "Today", "Overdue", "Upcoming", "P1"]
+                            readonly property int current: views.indexOf(taskViewModel.view)
+
+                            text: current < 0 ? "Project" : labels[current] + " (" + taskModel.viewCounts[views[current]] + ")"
+                            onClicked: taskViewModel.view = views[(current + 1) % views.length]
+
+                            contentItem: Text {
+                                text: parent.text
+                                font.pixelSize: 24
+                                color: textColor
+                                horizontalAlignment: Text.AlignHCenter
+                                verticalAlignment: Text.AlignVCenter
+                            }
+
+                            background: Rectangle {
+                                implicitWidth: 200
+                                implicitHeight: 70
+                                color: parent.pressed ? "#e0e0e0" : backgroundColor
+                                border.color: borderColor
+                                border.width: 3
+                            }
+                        }
+
+                        // Cycles the list ordering; the model keeps itself sorted
+                        Button {
+                            readonly property var orders: ["api", "priority", "due", "project"]
+                            readonly property var labels: ["Default", "Priority", "Due date", "Project"]
+
+                            text: "Sort: " + labels[Math.max(0, orders.indexOf(taskModel.sortOrder))]
+                            onClicked: {
+                                var next = (orders.indexOf(taskModel.sortOrder) + 1) % orders.length
+                                taskModel.sortOrder = orders[next]
+                            }
+
+                            contentItem: Text {
+                                text: parent.text
+                                font.pixelSize: 24
+                                color: textColor
+                                horizontalAlignment: Text.AlignHCenter
+                                verticalAlignment: Text.AlignVCenter
+                            }
+
+                            background: Rectangle {
+                                implicitWidth: 240
+                                implicitHeight: 70
+                                color: parent.pressed ? "#e0e0e0" : backgroundColor
+                                border.color: borderColor
+                                border.width: 3
+                            }
+                        }
+
+                        Button {
+                            text: "Search"
+                            onClicked: stackView.push(searchPage)
+
+                            contentItem: Text {
+                                text: parent.text
+                                font.pixelSize: 24
+                                color: textColor
+                                horizontalAlignment: Text.AlignHCenter
+                                verticalAlignment: Text.AlignVCenter
+                            }
+
+                            background: Rectangle {
+                                implicitWidth: 140
+                                implicitHeight: 70
+                                color: parent.pressed ? "#e0e0e0" : backgroundColor
+                                border.color: borderColor
+                                border.width: 3
+                            }
+                        }
+
                         // Add Task button
                         Button {
                             text: "Add"
@@ -166,16 +245,16 @@ ApplicationWindow {
                     Layout.fillWidth: true
                     Layout.fillHeight: true
 
-                    // Loading indicator
+                    // Loading indicator (only until the first rows stream in)
                     Text {
                         anchors.centerIn: parent
                         text: "Loading tasks..."
                         font.pixelSize: 36
                         color: mutedColor
-                        visible: appController.loading
+                        visible: appController.loading && taskModel.viewCounts.all === 0
                     }
 
-                    // Error message
+                    // Error message (saved tasks stay on screen instead, if there are any)
                     Text {
                         anchors.centerIn: parent
                         anchors.margins: 40
@@ -185,15 +264,24 @@ ApplicationWindow {
                         color: textColor
                         wrapMode: Text.WordWrap
                         horizontalAlignment: Text.AlignHCenter
-                        visible: appController.errorMessage !== "" && !appController.loading
+                        visible: appController.errorMessage !== "" && !appController.loading && taskModel.viewCounts.all === 0
+                    }
+
+                    // Smart view with nothing in it
+                    Text {
+                        anchors.centerIn: parent
+                        text: "No tasks in this view"
+                        font.pixelSize: 28
+                        color: mutedColor
+                        visible: taskList.count === 0 && taskModel.viewCounts.all > 0
                     }
 
                     // Task list
                     ListView {
                         id: taskList
                         anchors.fill: parent
-                        model: taskModel
-                        visible: !appController.loading && appController.errorMessage === ""
+                        model: taskViewModel
+                        visible: count > 0 || (appController.errorMessage === "" && !appController.loading)
                         clip: true
 
                         // Touch-friendly scrolling
@@ -204,6 +292,35 @@ ApplicationWindow {
                             width: taskList.width
                         }
 
+                        // Group headers (Overdue/Today/Upcoming, P1-P4, project)
+                        section.property: "section"
+                        section.criteria: ViewSection.FullString
+                        section.delegate: Rectangle {
+                            required property string section
+
+                            width: taskList.width
+                            height: section === "" ? 0 : 56
+                            visible: section !== ""
+                            color: "#f0f0f0"
+
+                            Text {
+                                anchors.left: parent.left
+                                anchors.leftMargin: 20
+                                anchors.verticalCenter: parent.verticalCenter
+                                text: parent.section
+                                font.pixelSize: 24
+                                font.bold: true
+                                color: textColor
+                            }
+
+                            Rectangle {
+                                anchors.bottom: parent.bottom
+                                width: parent.width
+                                height: 2
+                                color: borderColor
+                            }
+                        }
+
                         // Scrollbar
                         ScrollBar.vertical: ScrollBar {
                             policy: ScrollBar.AsNeeded
@@ -214,11 +331,23 @@ ApplicationWindow {
             }
         }
 
+        // Search page
+        Component {
+            id: searchPage
+
+            SearchScreen {
+                onClosed: stackView.pop()
+            }
+        }
+
         // Add task page
         Component {
             id: addTaskPage
 
             AddTaskScreen {
+                // The task is usually sent as soon as it is submitted; connect while the user writes
+                Component.onCompleted: appController.warmUpConnection()
+
                 // Wire up task submission
                 onTaskSubmitted: function(taskContent) {
                     appController.createTask(taskContent)
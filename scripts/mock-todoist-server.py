@@ -0,0 +1,320 @@
+#!/usr/bin/env python3
+#
+# Local stand-in for the Todoist API, for exercising the client offline.
+#
+# Serves the REST v2 endpoints the app uses plus the Sync API v9 endpoint
+# with real sync_token semantics, so delta sync can be tested end to end.
+#
+# Usage:
+#   ./scripts/mock-todoist-server.py                  # 50 tasks on port 8765
+#   ./scripts/mock-todoist-server.py --tasks 5000     # Large account
+#   ./scripts/mock-todoist-server.py --churn 10       # Edit a task every 10s
+#   ./scripts/mock-todoist-server.py --error-rate 0.2 # Fail 20% of sync commands
+#   ./scripts/mock-todoist-server.py --rate-limit 10  # 429 past 10 command requests a minute
+#
+# Point the app at it in ~/.config/remarkable-todoist/config.ini:
+#   [api]
+#   base_url=http://127.0.0.1:8765
+#
+# Control endpoints (for poking at the sync paths by hand):
+#   curl -X POST http://127.0.0.1:8765/mock/churn            # Change a few tasks now
+#   curl -X POST http://127.0.0.1:8765/mock/reset-tokens     # Invalidate issued sync tokens
+#
+
+import argparse
+import json
+import random
+import threading
+import time
+import urllib.parse
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+LOCK = threading.Lock()
+
+
+class State:
+    def __init__(self, task_count, project_count, error_rate=0.0, rate_limit=0):
+        self.error_rate = error_rate
+        self.rate_limit = rate_limit  # Command requests per minute, 0 = unlimited
+        self.command_times = []       # Recent command request timestamps
+        self.applied = {}       # command uuid -> status, so replays are idempotent
+        self.temp_ids = {}      # temp_id -> real id
+        self.revision = 0
+        self.epoch = 1          # Bumped to invalidate every issued token
+        self.next_id = 1000
+        self.projects = {}      # id -> {"id", "name", "is_deleted", "_rev"}
+        self.items = {}         # id -> item dict with "_rev"
+
+        for i in range(project_count):
+            self.add_project("Project %d" % (i + 1))
+        project_ids = list(self.projects)
+        for i in range(task_count):
+            self.add_item("Task %d" % (i + 1), random.choice(project_ids))
+
+    def new_id(self):
+        self.next_id += 1
+        return str(self.next_id)
+
+    def bump(self):
+        self.revision += 1
+        return self.revision
+
+    def add_project(self, name):
+        pid = self.new_id()
+        self.projects[pid] = {"id": pid, "name": name, "is_deleted": False, "_rev": self.bump()}
+        return self.projects[pid]
+
+    def add_item(self, content, project_id=None):
+        if project_id is None and self.projects:
+            project_id = next(iter(self.projects))
+        iid = self.new_id()
+        due = None
+        if random.random() < 0.5:
+            day = time.localtime(time.time() + random.randint(-5, 20) * 86400)
+            due = {"date": time.strftime("%Y-%m-%d", day)}
+        self.items[iid] = {
+            "id": iid,
+            "content": content,
+            "project_id": project_id,
+            "priority": random.randint(1, 4),
+            "checked": False,
+            "is_deleted": False,
+            "due": due,
+            "_rev": self.bump(),
+        }
+        return self.items[iid]
+
+    def close_item(self, iid):
+        item = self.items.get(iid)
+        if item is None:
+            return False
+        item["checked"] = True
+        item["_rev"] = self.bump()
+        return True
+
+    def churn(self, count=3):
+        active = [i for i in self.items.values() if not i["checked"] and not i["is_deleted"]]
+        for item in random.sample(active, min(count, len(active))):
+            action = random.random()
+            if action < 0.6:
+                item["content"] = item["content"].split(" (edited")[0] + " (edited %d)" % self.revision
+                item["priority"] = random.randint(1, 4)
+            elif action < 0.8:
+                item["checked"] = True
+            else:
+                item["is_deleted"] = True
+            item["_rev"] = self.bump()
+        self.add_item("New task %d" % self.revision)
+
+    def run_command(self, command):
+        """Apply one Sync API command, returning its sync_status entry."""
+        uuid = command.get("uuid", "")
+        if uuid in self.applied:
+            return self.applied[uuid]
+        if random.random() < self.error_rate:
+            return {"error_code": 500, "error": "Simulated failure"}
+
+        args = command.get("args", {})
+        kind = command.get("type")
+        if kind == "item_add":
+            item = self.add_item(args.get("content", ""), args.get("project_id"))
+            if command.get("temp_id"):
+                self.temp_ids[command["temp_id"]] = item["id"]
+            status = "ok"
+        elif kind == "item_close":
+            iid = self.temp_ids.get(args.get("id"), args.get("id"))
+            status = "ok" if self.close_item(iid) else {"error_code": 22, "error": "Item not found"}
+        else:
+            status = {"error_code": 37, "error": "Unknown command type"}
+
+        self.applied[uuid] = status
+        return status
+
+    def rate_limited(self):
+        """Seconds until another command request is allowed, 0 if allowed now."""
+        if not self.rate_limit:
+            return 0
+        now = time.time()
+        self.command_times = [t for t in self.command_times if now - t < 60]
+        if len(self.command_times) >= self.rate_limit:
+            return int(60 - (now - self.command_times[0])) + 1
+        self.command_times.append(now)
+        return 0
+
+    def token(self):
+        return "mock-%d-%d" % (self.epoch, self.revision)
+
+    def parse_token(self, token):
+        """Return the revision a token refers to, -1 for "*", None if invalid."""
+        if token == "*":
+            return -1
+        try:
+            _, epoch, rev = token.split("-")
+            epoch, rev = int(epoch), int(rev)
+        except ValueError:
+            return None
+        if epoch != self.epoch or rev > self.revision:
+            return None
+        return rev
+
+
+def public(obj):
+    return {k: v for k, v in obj.items() if not k.startswith("_")}
+
+
+def rest_task(item):
+    task = public(item)
+    task["is_completed"] = task.pop("checked")
+    task.pop("is_deleted")
+    return task
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    state = None
+
+    def log_message(self, fmt, *args):
+        print("[mock] " + fmt % args)
+
+    def send_json(self, status, payload):
+        body = json.dumps(payload).encode()
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def send_empty(self, status):
+        self.send_response(status)
+        self.send_header("Content-Length", "0")
+        self.end_headers()
+
+    def read_body(self):
+        length = int(self.headers.get("Content-Length", 0))
+        return self.rfile.read(length) if length else b""
+
+    def authorized(self):
+        if not self.headers.get("Authorization", "").startswith("Bearer "):
+            self.send_json(401, {"error": "Unauthorized"})
+            return False
+        return True
+
+    def do_GET(self):
+        if not self.authorized():
+            return
+        path = urllib.parse.urlparse(self.path).path
+        with LOCK:
+            st = self.state
+            if path == "/rest/v2/projects":
+                projects = [public(p) for p in st.projects.values() if not p["is_deleted"]]
+                return self.send_json(200, projects)
+            if path == "/rest/v2/tasks":
+                tasks = [rest_task(i) for i in st.items.values() if not i["checked"] and not i["is_deleted"]]
+                return self.send_json(200, tasks)
+        self.send_json(404, {"error": "Not found"})
+
+    def do_POST(self):
+        path = urllib.parse.urlparse(self.path).path
+        body = self.read_body()
+
+        if path == "/mock/churn":
+            with LOCK:
+                self.state.churn()
+            return self.send_empty(204)
+        if path == "/mock/reset-tokens":
+            with LOCK:
+                self.state.epoch += 1
+            return self.send_empty(204)
+
+        if not self.authorized():
+            return
+
+        with LOCK:
+            st = self.state
+            if path == "/sync/v9/sync":
+                return self.handle_sync(st, body)
+            if path == "/rest/v2/tasks":
+                payload = json.loads(body or b"{}")
+                item = st.add_item(payload.get("content", ""))
+                return self.send_json(200, rest_task(item))
+            parts = path.strip("/").split("/")
+            if len(parts) == 5 and parts[:3] == ["rest", "v2", "tasks"] and parts[4] == "close":
+                return self.send_empty(204 if st.close_item(parts[3]) else 404)
+        self.send_json(404, {"error": "Not found"})
+
+    def handle_sync(self, st, body):
+        form = urllib.parse.parse_qs(body.decode(), keep_blank_values=True)
+
+        if "commands" in form:
+            retry_after = st.rate_limited()
+            if retry_after:
+                body = json.dumps({"error": "Too many requests", "http_code": 429}).encode()
+                self.send_response(429)
+                self.send_header("Content-Type", "application/json")
+                self.send_header("Retry-After", str(retry_after))
+                self.send_header("Content-Length", str(len(body)))
+                self.end_headers()
+                self.wfile.write(body)
+                return
+            commands = json.loads(form["commands"][0])
+            statuses = {c.get("uuid", ""): st.run_command(c) for c in commands}
+            mapping = {c["temp_id"]: st.temp_ids[c["temp_id"]]
+                       for c in commands if c.get("temp_id") in st.temp_ids}
+            return self.send_json(200, {
+                "sync_status": statuses,
+                "temp_id_mapping": mapping,
+                "sync_token": st.token(),
+            })
+
+        token = form.get("sync_token", ["*"])[0]
+        since = st.parse_token(token)
+        if since is None:
+            return self.send_json(400, {
+                "error": "Invalid sync token",
+                "error_tag": "INVALID_SYNC_TOKEN",
+                "http_code": 400,
+            })
+
+        full = since < 0
+        if full:
+            projects = [public(p) for p in st.projects.values() if not p["is_deleted"]]
+            items = [public(i) for i in st.items.values() if not i["checked"] and not i["is_deleted"]]
+        else:
+            projects = [public(p) for p in st.projects.values() if p["_rev"] > since]
+            items = [public(i) for i in st.items.values() if i["_rev"] > since]
+
+        self.send_json(200, {
+            "sync_token": st.token(),
+            "full_sync": full,
+            "projects": projects,
+            "items": items,
+        })
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Local stand-in for the Todoist API")
+    parser.add_argument("--port", type=int, default=8765)
+    parser.add_argument("--tasks", type=int, default=50, help="number of seeded tasks")
+    parser.add_argument("--projects", type=int, default=5, help="number of seeded projects")
+    parser.add_argument("--churn", type=float, default=0, help="seconds between automatic edits (0 = off)")
+    parser.add_argument("--error-rate", type=float, default=0, help="fraction of sync commands that fail")
+    parser.add_argument("--rate-limit", type=int, default=0, help="command requests allowed per minute (0 = off)")
+    args = parser.parse_args()
+
+    Handler.state = State(args.tasks, args.projects, args.error_rate, args.rate_limit)
+
+    if args.churn > 0:
+        def churn_loop():
+            while True:
+                time.sleep(args.churn)
+                with LOCK:
+                    Handler.state.churn()
+        threading.Thread(target=churn_loop, daemon=True).start()
+
+    server = ThreadingHTTPServer(("127.0.0.1", args.port), Handler)
+    print("Mock Todoist API on http://127.0.0.1:%d (%d tasks)" % (args.port, args.tasks))
+    server.serve_forever()
+
+
+if __name__ == "__main__":
+    main()
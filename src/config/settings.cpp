@@ -9,6 +9,19 @@ namespace {
     const char* ORGANIZATION = "remarkable-todoist";
     const char* APPLICATION = "config";
     const char* API_TOKEN_KEY = "auth/api_token";
+    const char* API_BASE_URL_KEY = "api/base_url";
+    const char* DELTA_SYNC_KEY = "sync/delta_sync";
+    const char* SYNC_TOKEN_KEY = "sync/token";
+    const char* MAX_IN_FLIGHT_KEY = "sync/max_in_flight";
+    const char* SORT_ORDER_KEY = "ui/sort_order";
+    const char* PAGE_SIZE_KEY = "ui/page_size";
+    const char* VIEW_KEY = "ui/view";
+
+    const char* DEFAULT_API_BASE_URL = "https://api.todoist.com";
+    const int DEFAULT_MAX_IN_FLIGHT = 4;
+    const char* DEFAULT_SORT_ORDER = "api";
+    const int DEFAULT_PAGE_SIZE = 50;
+    const char* DEFAULT_VIEW = "all";
 
     QSettings createSettings()
     {
@@ -45,3 +58,76 @@ QString AppSettings::configFilePath()
     QSettings settings = createSettings();
     return settings.fileName();
 }
+
+QString AppSettings::apiBaseUrl()
+{
+    QSettings settings = createSettings();
+    QString url = settings.value(API_BASE_URL_KEY, DEFAULT_API_BASE_URL).toString();
+    while (url.endsWith('/')) {
+        url.chop(1);
+    }
+    return url;
+}
+
+bool AppSettings::deltaSyncEnabled()
+{
+    QSettings settings = createSettings();
+    return settings.value(DELTA_SYNC_KEY, true).toBool();
+}
+
+int AppSettings::maxInFlightRequests()
+{
+    QSettings settings = createSettings();
+    int value = settings.value(MAX_IN_FLIGHT_KEY, DEFAULT_MAX_IN_FLIGHT).toInt();
+    return qBound(1, value, 8);
+}
+
+QString AppSettings::getSyncToken()
+{
+    QSettings settings = createSettings();
+    return settings.value(SYNC_TOKEN_KEY).toString();
+}
+
+void AppSettings::setSyncToken(const QString& token)
+{
+    QSettings settings = createSettings();
+    if (token.isEmpty()) {
+        settings.remove(SYNC_TOKEN_KEY);
+    } else {
+        settings.setValue(SYNC_TOKEN_KEY, token);
+    }
+    settings.sync();
+}
+
+QString AppSettings::taskSortOrder()
+{
+    QSettings settings = createSettings();
+    return settings.value(SORT_ORDER_KEY, DEFAULT_SORT_ORDER).toString();
+}
+
+void AppSettings::setTaskSortOrder(const QString& sortOrder)
+{
+    QSettings settings = createSettings();
+    settings.setValue(SORT_ORDER_KEY, sortOrder);
+    settings.sync();
+}
+
+int AppSettings::taskPageSize()
+{
+    QSettings settings = createSettings();
+    int value = settings.value(PAGE_SIZE_KEY, DEFAULT_PAGE_SIZE).toInt();
+    return qBound(10, value, 1000);
+}
+
+QString AppSettings::taskView()
+{
+    QSettings settings = createSettings();
+    return settings.value(VIEW_KEY, DEFAULT_VIEW).toString();
+}
+
+void AppSettings::setTaskView(const QString& view)
+{
+    QSettings settings = createSettings();
+    settings.setValue(VIEW_KEY, view);
+    settings.sync();
+}
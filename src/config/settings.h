@@ -41,6 +41,69 @@ public:
      */
     static QString configFilePath();
 
+    /**
+     * @brief Get the base URL of the Todoist API
+     * @return "https://api.todoist.com" unless overridden by api/base_url
+     *
+     * Point this at scripts/mock-todoist-server.py to exercise the client
+     * without network access.
+     */
+    static QString apiBaseUrl();
+
+    /**
+     * @brief Check if refreshes should use incremental Sync API requests
+     * @return true unless sync/delta_sync is set to false
+     */
+    static bool deltaSyncEnabled();
+
+    /**
+     * @brief Get how many sync requests may be in flight at once
+     * @return sync/max_in_flight clamped to 1-8 (default 4)
+     */
+    static int maxInFlightRequests();
+
+    /**
+     * @brief Get the sync token from the last successful delta sync
+     * @return The stored token, or empty string if no sync has completed
+     */
+    static QString getSyncToken();
+
+    /**
+     * @brief Store the sync token returned by the Sync API
+     * @param token Token to send with the next delta sync (empty to clear)
+     */
+    static void setSyncToken(const QString& token);
+
+    /**
+     * @brief Get the task list ordering chosen in the UI
+     * @return "api", "priority", "due" or "project" (default "api")
+     */
+    static QString taskSortOrder();
+
+    /**
+     * @brief Store the task list ordering
+     * @param sortOrder One of the values returned by taskSortOrder()
+     */
+    static void setTaskSortOrder(const QString& sortOrder);
+
+    /**
+     * @brief Get how many task rows the list shows before fetching more
+     * @return ui/page_size clamped to 10-1000 (default 50)
+     */
+    static int taskPageSize();
+
+    /**
+     * @brief Get the smart view the task list was last showing
+     * @return "all", "today", "overdue", "upcoming", "p1" or "project:<id>" (default "all")
+     */
+    static QString taskView();
+
+    /**
+     * @brief Store the task list's smart view
+     * @param view One of the values returned by taskView()
+     */
+    static void setTaskView(const QString& view);
+
 private:
     // No instances needed - all methods are static
     AppSettings() = delete;
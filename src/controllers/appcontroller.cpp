@@ -4,26 +4,62 @@
 #include <QDebug>
 #include <QUuid>
 #include <QFileInfo>
+#include <QThread>
+#include <algorithm>
 
 #include "../models/task.h"
 #include "../models/taskmodel.h"
+#include "../models/task_search_model.h"
+#include "../models/task_view_model.h"
 #include "../network/todoist_client.h"
 #include "../network/sync_manager.h"
+#include "../models/task_snapshot.h"
 #include "../config/settings.h"
 
+// Quiet period after a change before the task snapshot is written
+static const int SNAPSHOT_DELAY_MS = 2000;
+
+// A refresh younger than this answers new refresh requests; an older one is superseded
+static const qint64 REFRESH_JOIN_MS = 15000;
+
 AppController::AppController(QObject *parent)
     : QObject(parent)
     , m_loading(false)
     , m_errorMessage("")
+    , m_projectsPending(false)
+    , m_tasksPending(false)
+    , m_streamingIntoModel(false)
+    , m_modelIncomplete(false)
+    , m_projectsLatencyMs(-1)
+    , m_tasksLatencyMs(-1)
+    , m_snapshotThread(nullptr)
+    , m_snapshotPending(false)
     , m_taskModel(nullptr)
+    , m_taskSearchModel(nullptr)
+    , m_taskViewModel(nullptr)
     , m_todoistClient(nullptr)
     , m_syncManager(nullptr)
 #ifdef ENABLE_OCR
     , m_recognizer(nullptr)
 #endif
 {
-    // Create task model
+    // Create task model, restoring the last chosen ordering and page size
     m_taskModel = new TaskModel(this);
+    m_taskModel->setSortOrder(AppSettings::taskSortOrder());
+    m_taskModel->setPageSize(AppSettings::taskPageSize());
+    connect(m_taskModel, &TaskModel::sortOrderChanged, this, [this]() {
+        AppSettings::setTaskSortOrder(m_taskModel->sortOrder());
+    });
+    m_taskSearchModel = new TaskSearchModel(m_taskModel, this);
+    m_taskViewModel = new TaskViewModel(m_taskModel, this);
+    m_taskViewModel->setView(AppSettings::taskView());
+    connect(m_taskViewModel, &TaskViewModel::viewChanged, this, [this]() {
+        AppSettings::setTaskView(m_taskViewModel->view());
+    });
+
+    m_snapshotTimer.setSingleShot(true);
+    m_snapshotTimer.setInterval(SNAPSHOT_DELAY_MS);
+    connect(&m_snapshotTimer, &QTimer::timeout, this, &AppController::saveSnapshot);
 
 #ifdef ENABLE_OCR
     // Create handwriting recognizer
@@ -33,6 +69,24 @@ AppController::AppController(QObject *parent)
 
 AppController::~AppController()
 {
+    // Write out changes still waiting for the debounce before exiting
+    bool unsaved = m_snapshotTimer.isActive() || m_snapshotPending;
+    m_snapshotTimer.stop();
+    m_snapshotPending = false;
+
+    if (m_snapshotThread) {
+        m_snapshotThread->wait();
+        delete m_snapshotThread;
+        m_snapshotThread = nullptr;
+    }
+    if (unsaved) {
+        saveSnapshot();
+    }
+    if (m_snapshotThread) {
+        m_snapshotThread->wait();
+        delete m_snapshotThread;
+        m_snapshotThread = nullptr;
+    }
 }
 
 void AppController::initialize()
@@ -58,9 +112,14 @@ void AppController::initialize()
     // Create Todoist client with the token
     QString token = AppSettings::getApiToken();
     m_todoistClient = new TodoistClient(token, this);
+    m_todoistClient->setApiBaseUrl(AppSettings::apiBaseUrl());
+
+    // Handshake while the snapshot loads
+    m_todoistClient->warmUp();
 
     // Create SyncManager after TodoistClient
     m_syncManager = new SyncManager(m_todoistClient, this);
+    m_syncManager->setMaxInFlight(AppSettings::maxInFlightRequests());
 
 #ifdef ENABLE_OCR
     // Initialize handwriting recognizer
@@ -76,16 +135,39 @@ void AppController::initialize()
             this, &AppController::onProjectsFetched);
     connect(m_todoistClient, &TodoistClient::tasksFetched,
             this, &AppController::onTasksFetched);
+    connect(m_todoistClient, &TodoistClient::tasksPartiallyFetched,
+            this, &AppController::onTasksPartiallyFetched);
+    connect(m_todoistClient, &TodoistClient::deltaFetched,
+            this, &AppController::onDeltaFetched);
+    connect(m_todoistClient, &TodoistClient::syncTokenInvalid,
+            this, &AppController::onSyncTokenInvalid);
     connect(m_todoistClient, &TodoistClient::errorOccurred,
             this, &AppController::onError);
 
-    // Connect SyncManager signals for task creation feedback
+    // Connect SyncManager signals for task creation feedback. A create is
+    // only confirmed once its queue record is on disk, so a crash right
+    // after the confirmation cannot lose it
+    connect(m_syncManager, &SyncManager::taskCreateQueued,
+            this, [this](const QString& tempId) {
+        qDebug() << "Task creation persisted, tempId:" << tempId;
+        emit taskCreated();
+    });
+
+    // Reconcile optimistic rows with their server IDs (the queue is
+    // rewritten by SyncManager), so no full refresh is needed
     connect(m_syncManager, &SyncManager::taskCreateSynced,
             this, [this](const QString& tempId, const QString& serverTaskId) {
         qDebug() << "Task synced, tempId:" << tempId << "-> serverId:" << serverTaskId;
+        if (!serverTaskId.isEmpty()) {
+            m_taskModel->replaceId(tempId, serverTaskId);
+            scheduleSnapshot();
+        }
     });
 
-    // Start fetch flow: projects first, then tasks
+    // Show the last known tasks right away; the refresh below revalidates them
+    loadSnapshot();
+
+    // Start fetch flow (delta sync, or projects then tasks)
     refresh();
 }
 
@@ -96,34 +178,243 @@ void AppController::refresh()
         return;
     }
 
+    // Single flight: join the refresh in progress unless it looks stuck
+    if (m_loading) {
+        qint64 age = m_refreshTimer.isValid() ? m_refreshTimer.elapsed() : 0;
+        if (age < REFRESH_JOIN_MS) {
+            qDebug() << "Refresh already in flight for" << age << "ms, joining it";
+            return;
+        }
+        qDebug() << "Superseding refresh started" << age << "ms ago";
+        m_todoistClient->cancelReads();
+    }
+
     setLoading(true);
     setErrorMessage("");
-    qDebug() << "Fetching projects from Todoist API...";
+
+    if (AppSettings::deltaSyncEnabled()) {
+        m_refreshTimer.start();
+
+        // No stored token means we have never synced: ask for everything
+        QString syncToken = AppSettings::getSyncToken();
+        if (syncToken.isEmpty()) {
+            syncToken = "*";
+        }
+        m_todoistClient->syncResources(syncToken);
+        return;
+    }
+
+    // Issue both requests at once; project names are joined in whichever order they land
+    qDebug() << "Fetching projects and tasks from Todoist API...";
+    m_projectsPending = true;
+    m_tasksPending = true;
+    m_projectsLatencyMs = -1;
+    m_tasksLatencyMs = -1;
+    m_refreshTimer.start();
+
+    // With nothing on screen yet, show rows as they stream in rather than all at the end
+    m_streamingIntoModel = (m_taskModel->taskCount() == 0);
     m_todoistClient->fetchProjects();
+    m_todoistClient->fetchAllTasks();
 }
 
 void AppController::onProjectsFetched(const QMap<QString, QString>& projects)
 {
-    Q_UNUSED(projects);
     qDebug() << "Projects fetched:" << projects.count() << "projects";
+    m_projectsPending = false;
+    m_projectsLatencyMs = m_refreshTimer.elapsed();
+    m_projectNames = projects;
 
-    // Now fetch tasks (TodoistClient will use cached project names)
-    m_todoistClient->fetchAllTasks();
+    // Tasks that arrived first were parsed without names - fill them in now
+    if (!m_tasksPending || m_streamingIntoModel) {
+        m_taskModel->applyProjectNames(projects);
+    }
+
+    finishFullRefresh();
 }
 
 void AppController::onTasksFetched(const QVector<Task>& tasks)
 {
     qDebug() << "Tasks fetched:" << tasks.count() << "tasks";
+    m_tasksPending = false;
+    m_tasksLatencyMs = m_refreshTimer.elapsed();
+
+    // Populate the model (a streamed cold load already holds every row)
+    if (m_streamingIntoModel) {
+        m_streamingIntoModel = false;
+    } else {
+        m_taskModel->setTasks(tasks);
+    }
 
-    // Populate the model
-    m_taskModel->setTasks(tasks);
+    // Projects landed while these tasks were parsing: the list may predate their names
+    if (!m_projectsPending) {
+        m_taskModel->applyProjectNames(m_projectNames);
+    }
+
+    finishFullRefresh();
+}
+
+void AppController::onTasksPartiallyFetched(const QVector<Task>& tasks)
+{
+    if (!m_streamingIntoModel) {
+        return;  // Warm refresh: swap in the complete list once it has arrived
+    }
+
+    if (m_taskModel->taskCount() == 0) {
+        qDebug() << "Time to first row:" << m_refreshTimer.elapsed() << "ms";
+    }
+    m_taskModel->appendTasks(tasks);
+}
+
+void AppController::finishFullRefresh()
+{
+    if (m_projectsPending || m_tasksPending) {
+        return;
+    }
+
+    // Serial fetching used to cost projects + tasks; in parallel it is the slower of the two
+    qDebug() << "Refresh latency:" << m_refreshTimer.elapsed() << "ms"
+             << "(projects" << m_projectsLatencyMs << "ms, tasks" << m_tasksLatencyMs << "ms,"
+             << "serial estimate" << (m_projectsLatencyMs + m_tasksLatencyMs) << "ms)";
+
+    // Done loading; the model holds the whole list again
+    m_modelIncomplete = false;
+    setLoading(false);
+    scheduleSnapshot();
+}
+
+void AppController::onDeltaFetched(const SyncDelta& delta)
+{
+    if (delta.fullSync || delta.projectsChanged) {
+        m_projectNames = delta.projectNames;
+    }
+
+    if (delta.fullSync) {
+        qDebug() << "Full sync:" << delta.tasks.count() << "tasks";
+        m_taskModel->setTasks(delta.tasks);
+        m_modelIncomplete = false;
+    } else {
+        qDebug() << "Delta sync:" << delta.tasks.count() << "changed," << delta.removedTaskIds.count() << "removed";
+        m_taskModel->applyDelta(delta.tasks, delta.removedTaskIds);
+
+        // Tasks untouched by this delta may still reference a renamed project
+        if (delta.projectsChanged) {
+            m_taskModel->applyProjectNames(delta.projectNames);
+        }
+    }
+
+    // Only persist the token once the model reflects it
+    AppSettings::setSyncToken(delta.syncToken);
+
+    qDebug() << "Refresh latency:" << m_refreshTimer.elapsed() << "ms (delta sync)";
 
     // Done loading
     setLoading(false);
+    scheduleSnapshot();
+}
+
+void AppController::onSyncTokenInvalid()
+{
+    qWarning() << "Stored sync token was rejected, performing full sync";
+    AppSettings::setSyncToken(QString());
+    m_todoistClient->syncResources("*");
+}
+
+void AppController::loadSnapshot()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QString filePath = TaskSnapshot::defaultFilePath();
+    TaskSnapshot snapshot;
+    if (!QFileInfo::exists(filePath) || !TaskSnapshot::load(filePath, &snapshot)) {
+        // A stored token would only fetch changes on top of an empty list
+        if (!AppSettings::getSyncToken().isEmpty()) {
+            qDebug() << "No task snapshot - next sync will be a full sync";
+            AppSettings::setSyncToken(QString());
+        }
+        return;
+    }
+
+    m_projectNames = snapshot.projectNames;
+    m_todoistClient->setProjectNames(snapshot.projectNames);
+    m_taskModel->setTasks(std::move(snapshot.tasks));
+
+    // Deltas must apply on top of exactly what the list shows
+    if (snapshot.syncToken != AppSettings::getSyncToken()) {
+        qDebug() << "Task snapshot is from another sync token - next sync will be a full sync";
+        AppSettings::setSyncToken(QString());
+    }
+
+    qDebug() << "Time to first row:" << timer.elapsed() << "ms (" << m_taskModel->taskCount()
+             << "tasks from snapshot saved" << snapshot.savedAt.toLocalTime().toString(Qt::ISODate) << ")";
+}
+
+void AppController::scheduleSnapshot()
+{
+    m_snapshotTimer.start();
+}
+
+void AppController::saveSnapshot()
+{
+    // A partial list saved with the current sync token would come back as
+    // the whole list on the next start; the refresh that completes it saves
+    if (m_modelIncomplete || m_streamingIntoModel) {
+        qDebug() << "Task list is incomplete, not saving a snapshot";
+        return;
+    }
+
+    if (m_snapshotThread) {
+        m_snapshotPending = true;  // Save again once this one is done
+        return;
+    }
+
+    // Copies share their data with the model; only later edits detach
+    TaskSnapshot snapshot;
+    snapshot.tasks = m_taskModel->tasks();
+    snapshot.projectNames = m_projectNames;
+    snapshot.syncToken = AppSettings::getSyncToken();
+    snapshot.savedAt = QDateTime::currentDateTimeUtc();
+    QString filePath = TaskSnapshot::defaultFilePath();
+
+    // Encoding and fsync of a large list would stall the UI, so write off-thread
+    m_snapshotThread = QThread::create([snapshot, filePath]() mutable {
+        // The model holds display order; the snapshot keeps API order
+        std::stable_sort(snapshot.tasks.begin(), snapshot.tasks.end(), [](const Task& a, const Task& b) {
+            return a.sourceOrder < b.sourceOrder;
+        });
+        if (TaskSnapshot::save(filePath, snapshot)) {
+            qDebug() << "Saved snapshot of" << snapshot.tasks.size() << "tasks";
+        }
+    });
+    m_snapshotThread->setObjectName("TaskSnapshot");
+    connect(m_snapshotThread, &QThread::finished, this, [this]() {
+        m_snapshotThread->deleteLater();
+        m_snapshotThread = nullptr;
+        if (m_snapshotPending) {
+            m_snapshotPending = false;
+            saveSnapshot();
+        }
+    });
+    m_snapshotThread->start();
 }
 
 void AppController::onError(const QString& error)
 {
+    // The refresh has failed; don't let the other half of it land afterwards
+    if (m_loading && m_todoistClient) {
+        m_todoistClient->cancelReads();
+    }
+
+    // Rows streamed so far stay on screen, but they are not the whole list
+    if (m_streamingIntoModel) {
+        m_modelIncomplete = true;
+    }
+
+    m_projectsPending = false;
+    m_tasksPending = false;
+    m_streamingIntoModel = false;
+
     qWarning() << "Todoist API error:" << error;
     setLoading(false);
     setErrorMessage(error);
@@ -154,11 +445,19 @@ void AppController::completeTask(const QString& taskId)
 {
     // Optimistic UI update
     m_taskModel->setTaskCompleted(taskId, true);
+    scheduleSnapshot();
 
     // Queue for sync
     m_syncManager->queueTaskCompletion(taskId);
 }
 
+void AppController::warmUpConnection()
+{
+    if (m_todoistClient) {
+        m_todoistClient->warmUp();
+    }
+}
+
 void AppController::createTask(const QString& content)
 {
     if (content.trimmed().isEmpty()) {
@@ -176,11 +475,11 @@ void AppController::createTask(const QString& content)
     newTask.priority = 1;  // Default priority
     newTask.completed = false;
     m_taskModel->addTask(newTask);
+    scheduleSnapshot();
 
-    // Queue for sync
+    // Queue for sync; taskCreated() follows once the queue has it on disk
     m_syncManager->queueTaskCreation(content.trimmed(), tempId);
 
-    emit taskCreated();
     qDebug() << "Task created (optimistic):" << content << "tempId:" << tempId;
 }
 
@@ -4,16 +4,21 @@
 #include <QObject>
 #include <QMap>
 #include <QVector>
+#include <QElapsedTimer>
+#include <QTimer>
 #include "../models/task.h"
 #include "../network/sync_manager.h"
+#include "../network/todoist_client.h"  // SyncDelta
 
 // OCR support is optional - only include if libraries are available
 #ifdef ENABLE_OCR
 #include "../ocr/handwriting_recognizer.h"
 #endif
 
-class TodoistClient;
 class TaskModel;
+class TaskSearchModel;
+class TaskViewModel;
+class QThread;
 
 /**
  * AppController - Orchestrates the application components for QML
@@ -47,6 +52,16 @@ public:
      */
     TaskModel* taskModel() const { return m_taskModel; }
 
+    /**
+     * Get the search-filtered view of the task list for QML binding
+     */
+    TaskSearchModel* taskSearchModel() const { return m_taskSearchModel; }
+
+    /**
+     * Get the task list filtered to the current smart view for QML binding
+     */
+    TaskViewModel* taskViewModel() const { return m_taskViewModel; }
+
     // Property accessors
     bool loading() const { return m_loading; }
     QString errorMessage() const { return m_errorMessage; }
@@ -55,7 +70,10 @@ public:
 public slots:
     /**
      * Refresh the task list
-     * Fetches projects then tasks from Todoist API
+     * Uses an incremental Sync API request when delta sync is enabled,
+     * otherwise fetches projects and tasks in parallel from the REST API.
+     * A call while a refresh is in flight joins it; if that refresh is
+     * older than 15 seconds it is aborted and a new one started instead.
      */
     void refresh();
 
@@ -69,6 +87,12 @@ public slots:
      */
     Q_INVOKABLE void createTask(const QString& content);
 
+    /**
+     * Open a connection to Todoist ahead of an expected request
+     * (e.g. while the add-task screen is open)
+     */
+    Q_INVOKABLE void warmUpConnection();
+
     /**
      * Recognize handwriting from an image file
      */
@@ -82,23 +106,49 @@ public slots:
 signals:
     void loadingChanged();
     void errorMessageChanged();
-    void taskCreated();
+    void taskCreated();  // A created task is queued on disk
 
 private slots:
     void onProjectsFetched(const QMap<QString, QString>& projects);
     void onTasksFetched(const QVector<Task>& tasks);
+    void onTasksPartiallyFetched(const QVector<Task>& tasks);
+    void onDeltaFetched(const SyncDelta& delta);
+    void onSyncTokenInvalid();
     void onError(const QString& error);
 
 private:
     void setLoading(bool loading);
     void setErrorMessage(const QString& message);
+    void finishFullRefresh();
+
+    // Offline snapshot: loaded before any request, saved after changes
+    void loadSnapshot();
+    void scheduleSnapshot();
+    void saveSnapshot();
 
     // State
     bool m_loading;
     QString m_errorMessage;
 
+    // Full (REST) refresh bookkeeping
+    bool m_projectsPending;
+    bool m_tasksPending;
+    bool m_streamingIntoModel;  // Cold load: rows are appended as they are parsed
+    bool m_modelIncomplete;     // A streamed load failed part way; not snapshotted until a full refresh
+    QElapsedTimer m_refreshTimer;
+    qint64 m_projectsLatencyMs;
+    qint64 m_tasksLatencyMs;
+
+    // Task snapshot persistence
+    QMap<QString, QString> m_projectNames;  // For the snapshot; the client has its own copy
+    QTimer m_snapshotTimer;                 // Coalesces bursts of changes into one save
+    QThread* m_snapshotThread;              // Save in progress, or null
+    bool m_snapshotPending;                 // Changed again while saving
+
     // Data layer
     TaskModel* m_taskModel;
+    TaskSearchModel* m_taskSearchModel;
+    TaskViewModel* m_taskViewModel;
     TodoistClient* m_todoistClient;
     SyncManager* m_syncManager;
 
@@ -5,6 +5,8 @@
 
 #include "controllers/appcontroller.h"
 #include "models/taskmodel.h"
+#include "models/task_search_model.h"
+#include "models/task_view_model.h"
 #include "network/sync_manager.h"
 
 int main(int argc, char *argv[])
@@ -33,6 +35,8 @@ int main(int argc, char *argv[])
     // Expose controller and model to QML
     engine.rootContext()->setContextProperty("appController", &controller);
     engine.rootContext()->setContextProperty("taskModel", controller.taskModel());
+    engine.rootContext()->setContextProperty("taskSearchModel", controller.taskSearchModel());
+    engine.rootContext()->setContextProperty("taskViewModel", controller.taskViewModel());
 
     // Connect QML Qt.quit() to application exit
     QObject::connect(&engine, &QQmlApplicationEngine::quit,
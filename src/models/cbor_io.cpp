@@ -0,0 +1,83 @@
+#include "cbor_io.h"
+#include <QDebug>
+
+bool MappedFile::open(const QString& filePath)
+{
+    close();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    qint64 size = m_file.size();
+    if (size == 0) {
+        return true;
+    }
+
+    m_map = m_file.map(0, size);
+    if (m_map) {
+        m_data = QByteArray::fromRawData(reinterpret_cast<const char*>(m_map), static_cast<int>(size));
+    } else {
+        qDebug() << "Could not map" << filePath << "- reading it instead";
+        m_data = m_file.readAll();
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    m_data.clear();
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+    m_file.close();
+}
+
+namespace CborIO {
+
+bool readString(QCborStreamReader& reader, QString* out)
+{
+    if (!reader.isString()) {
+        return false;
+    }
+
+    out->clear();
+    QCborStreamReader::StringResult<QString> chunk = reader.readString();
+    while (chunk.status == QCborStreamReader::Ok) {
+        out->append(chunk.data);
+        chunk = reader.readString();
+    }
+    return chunk.status == QCborStreamReader::EndOfString;
+}
+
+bool readInteger(QCborStreamReader& reader, qint64* out)
+{
+    if (!reader.isInteger()) {
+        return false;
+    }
+
+    *out = reader.toInteger();
+    return reader.next();
+}
+
+bool leaveContainer(QCborStreamReader& reader)
+{
+    while (reader.lastError() == QCborError::NoError && reader.hasNext()) {
+        reader.next();
+    }
+    return reader.lastError() == QCborError::NoError && reader.leaveContainer();
+}
+
+qint64 toEpochMs(const QDateTime& dateTime)
+{
+    return dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : -1;
+}
+
+QDateTime fromEpochMs(qint64 epochMs)
+{
+    return epochMs < 0 ? QDateTime() : QDateTime::fromMSecsSinceEpoch(epochMs);
+}
+
+} // namespace CborIO
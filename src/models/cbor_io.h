@@ -0,0 +1,56 @@
+#ifndef CBOR_IO_H
+#define CBOR_IO_H
+
+#include <QByteArray>
+#include <QCborStreamReader>
+#include <QDateTime>
+#include <QFile>
+#include <QString>
+
+/**
+ * @brief Read-only memory mapping of a local data file.
+ *
+ * data() wraps the mapped pages without copying, so decoders such as
+ * QCborStreamReader read straight from the page cache. Falls back to
+ * reading the file into memory when mapping is not possible.
+ */
+class MappedFile
+{
+public:
+    MappedFile() : m_map(nullptr) {}
+    ~MappedFile() { close(); }
+
+    bool open(const QString& filePath);
+    void close();
+
+    // Valid until close(); empty for an empty or unopened file
+    QByteArray data() const { return m_data; }
+    QString errorString() const { return m_file.errorString(); }
+
+private:
+    Q_DISABLE_COPY(MappedFile)
+
+    QFile m_file;
+    uchar* m_map;
+    QByteArray m_data;
+};
+
+// Helpers for decoding the compact CBOR files used for local persistence
+namespace CborIO {
+
+// Read a text string item and advance past it
+bool readString(QCborStreamReader& reader, QString* out);
+
+// Read an integer item and advance past it
+bool readInteger(QCborStreamReader& reader, qint64* out);
+
+// Skip whatever is left in the current container and leave it
+bool leaveContainer(QCborStreamReader& reader);
+
+// Timestamps are stored as epoch milliseconds, invalid ones as -1
+qint64 toEpochMs(const QDateTime& dateTime);
+QDateTime fromEpochMs(qint64 epochMs);
+
+} // namespace CborIO
+
+#endif // CBOR_IO_H
@@ -0,0 +1,97 @@
+#include "string_table.h"
+#include <QAtomicInteger>
+#include <QDebug>
+#include <QHash>
+#include <QReadWriteLock>
+
+namespace {
+    // Separates list entries; cannot appear in Todoist label names
+    const QChar LIST_SEPARATOR(0x1f);
+
+    // Values live in fixed-size chunks that are never moved or freed, so a
+    // published handle can be read without a lock (room for 4M strings)
+    const int CHUNK_BITS = 12;
+    const quint32 CHUNK_SIZE = 1u << CHUNK_BITS;
+    const int MAX_CHUNKS = 1024;
+
+    const QString EMPTY;
+
+    struct Storage {
+        QReadWriteLock lock;  // Guards handles and writers; readers of values skip it
+        QHash<QString, StringTable::Handle> handles;
+        QString* chunks[MAX_CHUNKS] = {};
+        QAtomicInteger<quint32> size{1};  // Published values; index 0 is the empty string
+
+        Storage() { chunks[0] = new QString[CHUNK_SIZE]; }
+    };
+
+    Storage& storage()
+    {
+        static Storage instance;
+        return instance;
+    }
+}
+
+StringTable::Handle StringTable::intern(const QString& value)
+{
+    if (value.isEmpty()) {
+        return 0;
+    }
+
+    Storage& s = storage();
+    {
+        QReadLocker locker(&s.lock);
+        auto it = s.handles.constFind(value);
+        if (it != s.handles.constEnd()) {
+            return it.value();
+        }
+    }
+
+    QWriteLocker locker(&s.lock);
+    // Another thread may have added it between the two locks
+    auto it = s.handles.constFind(value);
+    if (it != s.handles.constEnd()) {
+        return it.value();
+    }
+
+    Handle handle = s.size.loadRelaxed();
+    quint32 chunk = handle >> CHUNK_BITS;
+    if (chunk >= MAX_CHUNKS) {
+        qWarning() << "StringTable is full, dropping" << value;
+        return 0;
+    }
+    if (!s.chunks[chunk]) {
+        s.chunks[chunk] = new QString[CHUNK_SIZE];
+    }
+    s.chunks[chunk][handle & (CHUNK_SIZE - 1)] = value;
+    s.handles.insert(value, handle);
+
+    // Publish only once the slot is written; value() pairs this with an acquire
+    s.size.storeRelease(handle + 1);
+    return handle;
+}
+
+const QString& StringTable::value(Handle handle)
+{
+    Storage& s = storage();
+    if (handle == 0 || handle >= s.size.loadAcquire()) {
+        return EMPTY;
+    }
+    return s.chunks[handle >> CHUNK_BITS][handle & (CHUNK_SIZE - 1)];
+}
+
+StringTable::Handle StringTable::internList(const QStringList& values)
+{
+    return intern(values.join(LIST_SEPARATOR));
+}
+
+QStringList StringTable::list(Handle handle)
+{
+    const QString& joined = value(handle);
+    return joined.isEmpty() ? QStringList() : joined.split(LIST_SEPARATOR);
+}
+
+int StringTable::size()
+{
+    return static_cast<int>(storage().size.loadAcquire());
+}
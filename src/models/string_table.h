@@ -0,0 +1,40 @@
+#ifndef STRING_TABLE_H
+#define STRING_TABLE_H
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Process-wide table of interned strings.
+ *
+ * Values repeated across many tasks (project IDs, project names, label
+ * sets) are stored once and referenced from Task by a 32-bit handle.
+ * Equal strings always get the same handle, so equality checks compare
+ * integers. Handle 0 is the empty string.
+ *
+ * Entries live for the whole process; the set of distinct projects and
+ * labels is small, so the table is never pruned. Safe to use from the
+ * parser thread and the GUI thread at the same time. The table is
+ * append-only, so value() takes no lock and returns a reference that
+ * stays valid: sorting and data() never contend with interning.
+ */
+class StringTable
+{
+public:
+    using Handle = quint32;
+
+    static Handle intern(const QString& value);
+    static const QString& value(Handle handle);
+
+    // Label sets are interned as a whole so a task needs one handle for all of them
+    static Handle internList(const QStringList& values);
+    static QStringList list(Handle handle);
+
+    // Number of distinct strings, for diagnostics
+    static int size();
+
+private:
+    StringTable() = delete;
+};
+
+#endif // STRING_TABLE_H
@@ -1,177 +1,645 @@
 #include "sync_queue.h"
 #include <QStandardPaths>
-#include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QThread>
+#include "cbor_io.h"
+#include "sync_queue_writer.h"
 #include <QDebug>
 #include <QUuid>
 
+using namespace SyncQueueFormat;
+
+// Fold the log into a snapshot once it has this many records and
+// outweighs the queue itself, keeping the amortized cost per operation O(1)
+static const int COMPACT_MIN_RECORDS = 256;
+
+// Delay before retrying a snapshot that failed to write
+static const int SNAPSHOT_RETRY_MS = 5000;
+
+// Pre-binary queue file (JSON array with ISO dates), migrated on load
+static SyncOperation operationFromJson(const QJsonObject& jsonObj)
+{
+    SyncOperation op;
+    op.uuid = jsonObj["uuid"].toString();
+    op.type = jsonObj["type"].toString();
+    op.taskId = jsonObj["taskId"].toString();
+    op.content = jsonObj["content"].toString();
+    op.tempId = jsonObj["tempId"].toString();
+    op.queuedAt = QDateTime::fromString(jsonObj["queuedAt"].toString(), Qt::ISODate);
+    op.retryCount = jsonObj["retryCount"].toInt();
+    return op;
+}
+
 SyncQueue::SyncQueue(QObject* parent)
     : QObject(parent)
+    , m_logRecords(0)
+    , m_nextPosition(0)
+    , m_sequence(0)
+    , m_durableSequence(0)
 {
-    loadFromFile();
+    // Persisted state is loaded explicitly via loadFromFile(); all writes
+    // happen on the writer thread so taps never wait on the disk
+    m_writerThread = new QThread(this);
+    m_writerThread->setObjectName("SyncQueueWriter");
+    m_writer = new SyncQueueWriter(queueFilePath(), logFilePath());
+    m_writer->moveToThread(m_writerThread);
+    connect(m_writerThread, &QThread::finished, m_writer, &QObject::deleteLater);
+
+    connect(m_writer, &SyncQueueWriter::committed, this, &SyncQueue::onCommitted);
+    connect(m_writer, &SyncQueueWriter::logWriteFailed, this, &SyncQueue::saveToFile);
+    connect(m_writer, &SyncQueueWriter::snapshotWriteFailed, this, &SyncQueue::onSnapshotWriteFailed);
+
+    m_snapshotRetryTimer.setSingleShot(true);
+    m_snapshotRetryTimer.setInterval(SNAPSHOT_RETRY_MS);
+    connect(&m_snapshotRetryTimer, &QTimer::timeout, this, &SyncQueue::saveToFile);
+
+    m_writerThread->start();
 }
 
-void SyncQueue::enqueue(const SyncOperation& op)
+SyncQueue::~SyncQueue()
 {
-    m_operations.append(op);
-    saveToFile();
+    if (m_snapshotRetryTimer.isActive()) {
+        saveToFile();
+    }
+    if (!flush()) {
+        qWarning() << "Sync queue changes may not have reached the disk";
+    }
+    m_writerThread->quit();
+    m_writerThread->wait();
+}
+
+void SyncQueue::insertOperation(const SyncOperation& op)
+{
+    OperationIt it = m_operations.insert(m_operations.end(), op);
+    m_byUuid.insert(op.uuid, it);
+    m_positions.insert(op.uuid, m_nextPosition++);
+    if (!op.taskId.isEmpty()) {
+        m_byTaskId.insert(op.taskId, it);
+    }
+    if (op.type == "create_task" && !op.tempId.isEmpty()) {
+        m_createsByTempId.insert(op.tempId, it);
+    }
+}
+
+void SyncQueue::eraseOperation(OperationIt it)
+{
+    if (!it->taskId.isEmpty()) {
+        m_byTaskId.remove(it->taskId, it);
+    }
+    if (it->type == "create_task") {
+        m_createsByTempId.remove(it->tempId);
+    }
+    m_byUuid.remove(it->uuid);
+    m_positions.remove(it->uuid);
+    m_operations.erase(it);
+}
+
+void SyncQueue::replaceOperation(OperationIt it, const SyncOperation& op)
+{
+    // taskId changes when a created task gets its server ID
+    if (it->taskId != op.taskId) {
+        if (!it->taskId.isEmpty()) {
+            m_byTaskId.remove(it->taskId, it);
+        }
+        if (!op.taskId.isEmpty()) {
+            m_byTaskId.insert(op.taskId, it);
+        }
+    }
+    if (it->type == "create_task") {
+        m_createsByTempId.remove(it->tempId);
+    }
+    if (op.type == "create_task" && !op.tempId.isEmpty()) {
+        m_createsByTempId.insert(op.tempId, it);
+    }
+    *it = op;
+}
+
+void SyncQueue::clearOperations()
+{
+    m_operations.clear();
+    m_byUuid.clear();
+    m_positions.clear();
+    m_byTaskId.clear();
+    m_createsByTempId.clear();
+}
+
+SyncQueue::EnqueueResult SyncQueue::enqueue(const SyncOperation& op, const QSet<QString>& busyUuids)
+{
+    if (m_byUuid.contains(op.uuid)) {
+        qWarning() << "SyncQueue::enqueue: duplicate uuid" << op.uuid;
+        return Dropped;
+    }
+
+    if (op.type == "close_task") {
+        if (hasOperationForTask(op.taskId, "close_task")) {
+            qDebug() << "Task" << op.taskId << "already has a queued close, dropping duplicate";
+            return Dropped;
+        }
+
+        // Closing a task that hasn't been created on the server yet:
+        // create it as completed instead of sending a second command later
+        auto create = m_createsByTempId.constFind(op.taskId);
+        if (create != m_createsByTempId.constEnd()) {
+            if (create.value()->closeAfterCreate) {
+                return Dropped;
+            }
+            if (!busyUuids.contains(create.value()->uuid)) {
+                SyncOperation merged = *create.value();
+                merged.closeAfterCreate = true;
+                updateOperation(merged);
+                qDebug() << "Folded close of" << op.taskId << "into its queued create";
+                emit operationCoalesced(merged.uuid);
+                return Coalesced;
+            }
+        }
+    }
+
+    insertOperation(op);
+
+    appendLog(operationRecord(LogAdd, op));
+    m_awaitingDisk.append(qMakePair(m_sequence, op.uuid));
+
     emit countChanged();
+    return Enqueued;
 }
 
 SyncOperation SyncQueue::dequeue()
 {
-    if (m_operations.isEmpty()) {
+    if (m_operations.empty()) {
         qWarning() << "SyncQueue::dequeue() called on empty queue";
         return SyncOperation();
     }
 
-    SyncOperation op = m_operations.takeFirst();
-    saveToFile();
+    SyncOperation op = m_operations.front();
+    eraseOperation(m_operations.begin());
+
+    appendLog(ackRecord(QStringList{op.uuid}));
+
+    emit operationsRemoved(QStringList{op.uuid});
     emit countChanged();
     return op;
 }
 
 SyncOperation SyncQueue::peek() const
 {
-    if (m_operations.isEmpty()) {
+    if (m_operations.empty()) {
         qWarning() << "SyncQueue::peek() called on empty queue";
         return SyncOperation();
     }
 
-    return m_operations.first();
+    return m_operations.front();
 }
 
 bool SyncQueue::isEmpty() const
 {
-    return m_operations.isEmpty();
+    return m_operations.empty();
 }
 
 int SyncQueue::count() const
 {
-    return m_operations.size();
+    return static_cast<int>(m_operations.size());
 }
 
 void SyncQueue::clear()
 {
-    m_operations.clear();
+    QStringList uuids = m_byUuid.keys();
+    clearOperations();
     saveToFile();
+    emit operationsRemoved(uuids);
     emit countChanged();
 }
 
+QVector<SyncOperation> SyncQueue::peekBatch(int maxCount) const
+{
+    QVector<SyncOperation> batch;
+    batch.reserve(qMin(maxCount, count()));
+    for (auto it = m_operations.cbegin(); it != m_operations.cend() && batch.size() < maxCount; ++it) {
+        batch.append(*it);
+    }
+    return batch;
+}
+
+int SyncQueue::removeOperations(const QStringList& uuids)
+{
+    QStringList removed;
+    for (const QString& uuid : uuids) {
+        auto found = m_byUuid.constFind(uuid);
+        if (found != m_byUuid.constEnd()) {
+            eraseOperation(found.value());
+            removed.append(uuid);
+        }
+    }
+
+    if (!removed.isEmpty()) {
+        // Unknown uuids are harmless on replay, so log the request as given
+        appendLog(ackRecord(uuids));
+
+        emit operationsRemoved(removed);
+        emit countChanged();
+    }
+    return removed.size();
+}
+
+bool SyncQueue::updateOperation(const SyncOperation& op)
+{
+    auto found = m_byUuid.constFind(op.uuid);
+    if (found == m_byUuid.constEnd()) {
+        qWarning() << "SyncQueue::updateOperation: no operation with uuid" << op.uuid;
+        return false;
+    }
+
+    replaceOperation(found.value(), op);
+
+    appendLog(operationRecord(LogUpdate, op));
+    return true;
+}
+
+bool SyncQueue::contains(const QString& uuid) const
+{
+    return m_byUuid.contains(uuid);
+}
+
 bool SyncQueue::hasOperationForTask(const QString& taskId, const QString& type) const
 {
-    for (const SyncOperation& op : m_operations) {
-        if (op.taskId == taskId && op.type == type) {
+    // A task has at most a handful of queued operations
+    for (auto it = m_byTaskId.constFind(taskId); it != m_byTaskId.constEnd() && it.key() == taskId; ++it) {
+        if (it.value()->type == type) {
             return true;
         }
     }
     return false;
 }
 
+SyncOperation SyncQueue::operation(const QString& uuid) const
+{
+    auto it = m_byUuid.constFind(uuid);
+    return it != m_byUuid.constEnd() ? *it.value() : SyncOperation();
+}
+
+bool SyncQueue::hasEarlierOperationForTask(const QString& uuid, const QString& taskId) const
+{
+    quint64 position = m_positions.value(uuid);
+    for (auto it = m_byTaskId.constFind(taskId); it != m_byTaskId.constEnd() && it.key() == taskId; ++it) {
+        if (m_positions.value(it.value()->uuid) < position) {
+            return true;
+        }
+    }
+
+    // Creates of optimistic tasks are indexed by temp ID only
+    auto create = m_createsByTempId.constFind(taskId);
+    return create != m_createsByTempId.constEnd() && m_positions.value(create.value()->uuid) < position;
+}
+
+int SyncQueue::replaceTaskId(const QString& oldTaskId, const QString& newTaskId)
+{
+    if (oldTaskId.isEmpty() || newTaskId.isEmpty() || oldTaskId == newTaskId) {
+        return 0;
+    }
+
+    // Copy first: replaceOperation() re-keys the index being read
+    const QList<OperationIt> affected = m_byTaskId.values(oldTaskId);
+    for (OperationIt it : affected) {
+        SyncOperation op = *it;
+        op.taskId = newTaskId;
+        replaceOperation(it, op);
+        appendLog(operationRecord(LogUpdate, op));
+    }
+
+    if (!affected.isEmpty()) {
+        qDebug() << "Rewrote" << affected.size() << "queued operations from" << oldTaskId << "to" << newTaskId;
+    }
+    return affected.size();
+}
+
 QString SyncQueue::queueFilePath() const
+{
+    QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    return appDataPath + "/sync_queue.cbor";
+}
+
+QString SyncQueue::legacyQueueFilePath() const
 {
     QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
     return appDataPath + "/sync_queue.json";
 }
 
-void SyncQueue::saveToFile()
+QString SyncQueue::logFilePath() const
 {
-    QString filePath = queueFilePath();
+    QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    return appDataPath + "/sync_queue.log";
+}
 
-    // Create parent directory if needed
-    QFileInfo fileInfo(filePath);
-    QDir dir = fileInfo.dir();
-    if (!dir.exists()) {
-        if (!dir.mkpath(".")) {
-            qWarning() << "Failed to create directory:" << dir.path();
-            return;
-        }
+void SyncQueue::appendLog(const QByteArray& record)
+{
+    // A drained queue snapshots to almost nothing - cheaper than logging
+    if (m_operations.empty()) {
+        saveToFile();
+        return;
     }
 
-    // Serialize operations to JSON
-    QJsonArray jsonArray;
-    for (const SyncOperation& op : m_operations) {
-        QJsonObject jsonObj;
-        jsonObj["uuid"] = op.uuid;
-        jsonObj["type"] = op.type;
-        jsonObj["taskId"] = op.taskId;
-        jsonObj["content"] = op.content;
-        jsonObj["tempId"] = op.tempId;
-        jsonObj["queuedAt"] = op.queuedAt.toString(Qt::ISODate);
-        jsonObj["retryCount"] = op.retryCount;
-        jsonArray.append(jsonObj);
-    }
+    quint64 sequence = ++m_sequence;
+    QMetaObject::invokeMethod(m_writer, [writer = m_writer, sequence, record]() {
+        writer->appendRecord(sequence, record);
+    }, Qt::QueuedConnection);
 
-    // Write to file
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly)) {
-        qWarning() << "Failed to open file for writing:" << filePath << file.errorString();
-        return;
+    ++m_logRecords;
+    if (m_logRecords >= COMPACT_MIN_RECORDS && m_logRecords >= 2 * count()) {
+        saveToFile();
     }
+}
 
-    QJsonDocument doc(jsonArray);
-    file.write(doc.toJson(QJsonDocument::Compact));
-    file.close();
+void SyncQueue::saveToFile()
+{
+    // Copying the list is cheap (implicitly shared strings); encoding and
+    // writing happen on the writer thread
+    QVector<SyncOperation> operations(m_operations.begin(), m_operations.end());
+    quint64 sequence = ++m_sequence;
+    QMetaObject::invokeMethod(m_writer, [writer = m_writer, sequence, operations]() {
+        writer->writeSnapshot(sequence, operations);
+    }, Qt::QueuedConnection);
 
-    qDebug() << "Saved" << m_operations.size() << "operations to" << filePath;
+    m_logRecords = 0;
+    m_snapshotRetryTimer.stop();  // This attempt supersedes a pending retry
+}
+
+bool SyncQueue::flush()
+{
+    bool ok = false;
+    QMetaObject::invokeMethod(m_writer, [writer = m_writer]() {
+        return writer->commit();
+    }, Qt::BlockingQueuedConnection, &ok);
+    return ok;
+}
+
+bool SyncQueue::isPersisted() const
+{
+    return m_durableSequence == m_sequence;
+}
+
+void SyncQueue::onCommitted(quint64 sequence)
+{
+    m_durableSequence = qMax(m_durableSequence, sequence);
+
+    QStringList persisted;
+    while (!m_awaitingDisk.isEmpty() && m_awaitingDisk.first().first <= m_durableSequence) {
+        persisted.append(m_awaitingDisk.takeFirst().second);
+    }
+    if (!persisted.isEmpty()) {
+        emit operationsPersisted(persisted);
+    }
+}
+
+void SyncQueue::onSnapshotWriteFailed()
+{
+    // Until a snapshot lands, a cleared queue or a dead log would come back
+    // wrong on the next start; memory is still authoritative, so write it again
+    qWarning() << "Sync queue snapshot was not saved, retrying in" << SNAPSHOT_RETRY_MS / 1000 << "s";
+    m_snapshotRetryTimer.start();
 }
 
 void SyncQueue::loadFromFile()
 {
-    QString filePath = queueFilePath();
+    clearOperations();
 
-    QFile file(filePath);
-    if (!file.exists()) {
+    bool migrated = false;
+    quint64 generation = 0;
+    if (QFile::exists(queueFilePath())) {
+        loadSnapshot(queueFilePath(), &generation);
+    } else if (QFile::exists(legacyQueueFilePath())) {
+        migrated = loadLegacyFile(legacyQueueFilePath());
+    } else {
         qDebug() << "Sync queue file does not exist, starting with empty queue";
-        return;
     }
 
+    QMetaObject::invokeMethod(m_writer, [writer = m_writer, generation]() {
+        writer->setGeneration(generation);
+    }, Qt::QueuedConnection);
+
+    int replayed = replayLog(generation);
+
+    qDebug() << "Loaded" << count() << "operations"
+             << "(" << replayed << "log records replayed)";
+
+    // Start from a clean log; this also drops any torn tail found on replay
+    bool dirty = migrated || replayed > 0 || QFileInfo(logFilePath()).size() > 0;
+    if (dirty) {
+        saveToFile();
+
+        // Only drop the old file once the new snapshot is on disk
+        if (migrated && flush()) {
+            QFile::remove(legacyQueueFilePath());
+            qDebug() << "Migrated sync queue to" << queueFilePath();
+        }
+    }
+}
+
+bool SyncQueue::loadSnapshot(const QString& filePath, quint64* generation)
+{
+    MappedFile mapped;
+    if (!mapped.open(filePath)) {
+        qWarning() << "Failed to open file for reading:" << filePath << mapped.errorString();
+        return false;
+    }
+
+    QCborStreamReader reader(mapped.data());
+    if (!reader.isMap() || !reader.enterContainer()) {
+        qWarning() << "Expected CBOR map in sync queue file";
+        return false;
+    }
+
+    QStringList types;
+    while (reader.lastError() == QCborError::NoError && reader.hasNext()) {
+        QString key;
+        if (!CborIO::readString(reader, &key)) {
+            break;
+        }
+
+        if (key == "v") {
+            qint64 version = 0;
+            if (!CborIO::readInteger(reader, &version)) {
+                break;
+            }
+            if (version > SNAPSHOT_VERSION) {
+                qWarning() << "Sync queue file has unsupported version" << version;
+                return false;
+            }
+        } else if (key == "gen") {
+            qint64 value = 0;
+            if (!CborIO::readInteger(reader, &value)) {
+                break;
+            }
+            *generation = static_cast<quint64>(qMax<qint64>(0, value));
+        } else if (key == "types") {
+            if (!reader.isArray() || !reader.enterContainer()) {
+                break;
+            }
+            QString type;
+            while (reader.hasNext() && CborIO::readString(reader, &type)) {
+                types.append(type);
+            }
+            if (!reader.leaveContainer()) {
+                break;
+            }
+        } else if (key == "ops") {
+            if (!reader.isArray() || !reader.enterContainer()) {
+                break;
+            }
+            while (reader.hasNext()) {
+                SyncOperation op;
+                if (!readOperation(reader, types, &op)) {
+                    break;
+                }
+                if (!m_byUuid.contains(op.uuid)) {
+                    insertOperation(op);
+                }
+            }
+            if (!reader.leaveContainer()) {
+                break;
+            }
+        } else {
+            reader.next();  // Field from a newer version
+        }
+    }
+
+    if (reader.lastError() != QCborError::NoError || !reader.leaveContainer()) {
+        qWarning() << "Failed to parse sync queue file:" << reader.lastError().toString()
+                   << "- kept" << count() << "operations";
+        return false;
+    }
+    return true;
+}
+
+bool SyncQueue::loadLegacyFile(const QString& filePath)
+{
+    QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly)) {
         qWarning() << "Failed to open file for reading:" << filePath << file.errorString();
-        return;
+        return false;
     }
 
-    QByteArray data = file.readAll();
-    file.close();
-
     QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    file.close();
 
     if (parseError.error != QJsonParseError::NoError) {
         qWarning() << "Failed to parse JSON:" << parseError.errorString();
-        return;
+        return false;
     }
 
     if (!doc.isArray()) {
         qWarning() << "Expected JSON array in sync queue file";
-        return;
+        return false;
     }
 
-    // Deserialize operations from JSON
-    QJsonArray jsonArray = doc.array();
-    m_operations.clear();
-
-    for (const QJsonValue& value : jsonArray) {
+    for (const QJsonValue& value : doc.array()) {
         if (!value.isObject()) {
             qWarning() << "Skipping non-object value in sync queue";
             continue;
         }
+        SyncOperation op = operationFromJson(value.toObject());
+        if (!m_byUuid.contains(op.uuid)) {
+            insertOperation(op);
+        }
+    }
+    return true;
+}
+
+int SyncQueue::replayLog(quint64 snapshotGeneration)
+{
+    QString filePath = logFilePath();
+    if (!QFile::exists(filePath)) {
+        return 0;
+    }
+
+    MappedFile mapped;
+    if (!mapped.open(filePath)) {
+        qWarning() << "Failed to open sync log for reading:" << filePath << mapped.errorString();
+        return 0;
+    }
 
-        QJsonObject jsonObj = value.toObject();
+    const QByteArray data = mapped.data();
+    QCborStreamReader reader(data);
+    int replayed = 0;
+    int stale = 0;
+    quint64 generation = 0;  // Logs from before generations existed count as 0
+
+    while (reader.currentOffset() < data.size()) {
+        qint64 recordStart = reader.currentOffset();
+
+        // Decode the whole record before applying it, so a record cut off
+        // by a crash mid-append is never half applied
+        qint64 kind = -1;
         SyncOperation op;
-        op.uuid = jsonObj["uuid"].toString();
-        op.type = jsonObj["type"].toString();
-        op.taskId = jsonObj["taskId"].toString();
-        op.content = jsonObj["content"].toString();
-        op.tempId = jsonObj["tempId"].toString();
-        op.queuedAt = QDateTime::fromString(jsonObj["queuedAt"].toString(), Qt::ISODate);
-        op.retryCount = jsonObj["retryCount"].toInt();
+        QStringList uuids;
+        bool ok = reader.isArray() && reader.enterContainer()
+                  && CborIO::readInteger(reader, &kind);
+
+        if (ok && (kind == LogAdd || kind == LogUpdate)) {
+            ok = readOperation(reader, QStringList(), &op) && CborIO::leaveContainer(reader);
+        } else if (ok && kind == LogGeneration) {
+            qint64 value = 0;
+            ok = CborIO::readInteger(reader, &value) && CborIO::leaveContainer(reader);
+            if (ok) {
+                generation = static_cast<quint64>(qMax<qint64>(0, value));
+                continue;
+            }
+        } else if (ok && kind == LogAck) {
+            QString uuid;
+            while (ok && reader.hasNext()) {
+                ok = CborIO::readString(reader, &uuid);
+                uuids.append(uuid);
+            }
+            ok = ok && reader.leaveContainer();
+        } else if (ok) {
+            ok = CborIO::leaveContainer(reader);
+            if (ok) {
+                qWarning() << "Skipping unknown sync log record:" << kind;
+                continue;
+            }
+        }
+
+        if (!ok) {
+            qWarning() << "Discarding torn or corrupt sync log from offset" << recordStart;
+            break;
+        }
+
+        // Written before the snapshot was taken: already folded into it,
+        // and its adds may since have been acknowledged
+        if (generation < snapshotGeneration) {
+            ++stale;
+            continue;
+        }
 
-        m_operations.append(op);
+        applyLogRecord(static_cast<int>(kind), op, uuids);
+        ++replayed;
     }
 
-    qDebug() << "Loaded" << m_operations.size() << "operations from" << filePath;
+    if (stale > 0) {
+        qWarning() << "Skipped" << stale << "sync log records older than the snapshot";
+    }
+    return replayed;
+}
+
+void SyncQueue::applyLogRecord(int kind, const SyncOperation& op, const QStringList& uuids)
+{
+    if (kind == LogAdd || kind == LogUpdate) {
+        auto found = m_byUuid.constFind(op.uuid);
+        if (found != m_byUuid.constEnd()) {
+            replaceOperation(found.value(), op);
+        } else if (kind == LogAdd) {
+            insertOperation(op);
+        }
+        // Updates for operations already acknowledged are dropped
+    } else if (kind == LogAck) {
+        for (const QString& uuid : uuids) {
+            auto found = m_byUuid.constFind(uuid);
+            if (found != m_byUuid.constEnd()) {
+                eraseOperation(found.value());
+            }
+        }
+    }
 }
@@ -4,7 +4,18 @@
 #include <QObject>
 #include <QVector>
 #include <QString>
+#include <QStringList>
 #include <QDateTime>
+#include <QHash>
+#include <QMultiHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <QTimer>
+#include <list>
+
+class QThread;
+class SyncQueueWriter;
 
 struct SyncOperation {
     QString uuid;           // Unique ID for idempotency (QUuid::createUuid())
@@ -14,10 +25,33 @@ struct SyncOperation {
     QString tempId;         // Temporary ID for tracking optimistic UI entries
     QDateTime queuedAt;     // When queued
     int retryCount;         // Number of sync attempts
+    bool closeAfterCreate;  // create_task only: a later close was folded in (create as completed)
 
-    SyncOperation() : retryCount(0) {}
+    SyncOperation() : retryCount(0), closeAfterCreate(false) {}
 };
 
+/**
+ * @brief Persistent FIFO of pending sync operations.
+ *
+ * On disk the queue is a CBOR snapshot (sync_queue.cbor) plus an
+ * append-only log (sync_queue.log) of CBOR records: add, ack or update.
+ * Each mutation appends a single record, so persisting an operation costs
+ * the same regardless of backlog size. Records are written and fsynced by
+ * a SyncQueueWriter on its own thread; mutating methods only touch memory.
+ * The log is folded into a fresh snapshot once it outgrows the queue, when
+ * the queue drains, and after recovery in loadFromFile(); a snapshot that
+ * fails to write is retried. Both files are read through a memory mapping;
+ * an old sync_queue.json is migrated on first load. operationsPersisted()
+ * reports when enqueued operations have reached the disk, and flush()
+ * blocks until everything so far has.
+ *
+ * In memory the operations sit in a linked list indexed by uuid and by
+ * taskId, so enqueue, dequeue, removal by uuid, in-place updates
+ * and duplicate checks are all constant time.
+ *
+ * enqueue() coalesces: a close repeating a queued close is dropped, and a
+ * close of a task whose create is still queued is folded into that create.
+ */
 class SyncQueue : public QObject
 {
     Q_OBJECT
@@ -25,29 +59,91 @@ class SyncQueue : public QObject
 
 public:
     explicit SyncQueue(QObject* parent = nullptr);
+    ~SyncQueue();
+
+    enum EnqueueResult {
+        Enqueued,   // Added to the back of the queue
+        Coalesced,  // Merged into an operation already queued
+        Dropped     // Redundant with an operation already queued
+    };
 
-    // Queue operations
-    void enqueue(const SyncOperation& op);
+    // Queue operations. Operations listed in busyUuids are already being
+    // sent and are never rewritten by coalescing.
+    EnqueueResult enqueue(const SyncOperation& op, const QSet<QString>& busyUuids = QSet<QString>());
     SyncOperation dequeue();           // Remove and return front
     SyncOperation peek() const;        // View front without removing
     bool isEmpty() const;
     int count() const;
     void clear();
 
-    // Find operation by task ID (for deduplication)
+    // Batch access (for submitting several operations in one request)
+    QVector<SyncOperation> peekBatch(int maxCount) const;  // Front operations, in order
+    int removeOperations(const QStringList& uuids);        // Remove by uuid, returns count removed
+    bool updateOperation(const SyncOperation& op);         // Replace in place by uuid
+
+    // Find operation by uuid / task ID (for deduplication)
+    bool contains(const QString& uuid) const;
     bool hasOperationForTask(const QString& taskId, const QString& type) const;
+    SyncOperation operation(const QString& uuid) const;   // Default-constructed if not queued
+
+    // Whether an operation queued before uuid targets the same task: one
+    // with that taskId, or a create whose tempId it is
+    bool hasEarlierOperationForTask(const QString& uuid, const QString& taskId) const;
+
+    // Point queued operations at a task's server ID once its create synced
+    int replaceTaskId(const QString& oldTaskId, const QString& newTaskId);
 
     // Persistence
-    void saveToFile();
-    void loadFromFile();
+    void saveToFile();      // Queue a full snapshot that truncates the log (compaction)
+    void loadFromFile();    // Load the snapshot and replay the log on top
+    bool flush();           // Block until every change so far is on disk; false if a write failed
+    bool isPersisted() const;  // No changes waiting for the writer
 
 signals:
     void countChanged();
+    void operationsRemoved(const QStringList& uuids);  // Left the queue (acked, dropped or cleared)
+    void operationCoalesced(const QString& uuid);      // Rewritten to absorb a newly enqueued operation
+    void operationsPersisted(const QStringList& uuids);  // Enqueued operations now on disk
+
+private slots:
+    void onCommitted(quint64 sequence);
+    void onSnapshotWriteFailed();
 
 private:
+    typedef std::list<SyncOperation>::iterator OperationIt;
+
+    // Keep the lookup indexes in step with m_operations
+    void insertOperation(const SyncOperation& op);
+    void eraseOperation(OperationIt it);
+    void replaceOperation(OperationIt it, const SyncOperation& op);
+    void clearOperations();
+
     QString queueFilePath() const;
+    QString legacyQueueFilePath() const;
+    QString logFilePath() const;
+
+    bool loadSnapshot(const QString& filePath, quint64* generation);
+    bool loadLegacyFile(const QString& filePath);
+
+    // Write-ahead log
+    void appendLog(const QByteArray& record);
+    int replayLog(quint64 snapshotGeneration);  // Skips records older than the snapshot
+    void applyLogRecord(int kind, const SyncOperation& op, const QStringList& uuids);
+
+    std::list<SyncOperation> m_operations;      // Queue order
+    QHash<QString, OperationIt> m_byUuid;       // uuid -> position
+    QMultiHash<QString, OperationIt> m_byTaskId;    // taskId -> queued operations
+    QHash<QString, OperationIt> m_createsByTempId;  // tempId -> queued create_task
+    int m_logRecords;       // Records in the log since the last snapshot
+    QHash<QString, quint64> m_positions;  // uuid -> enqueue order, for "queued before" checks
+    quint64 m_nextPosition;
 
-    QVector<SyncOperation> m_operations;
+    QThread* m_writerThread;
+    SyncQueueWriter* m_writer;
+    quint64 m_sequence;         // Last change handed to the writer
+    quint64 m_durableSequence;  // Last change the writer reported on disk
+    QList<QPair<quint64, QString>> m_awaitingDisk;  // Enqueued uuids by sequence, not yet on disk
+    QTimer m_snapshotRetryTimer;  // Retries a snapshot the writer failed to save
 };
 
 #endif // SYNC_QUEUE_H
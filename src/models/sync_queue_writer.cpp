@@ -0,0 +1,297 @@
+#include "sync_queue_writer.h"
+#include "cbor_io.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTimer>
+#include <QDebug>
+#include <unistd.h>
+
+// Longest a queued mutation waits before it is written and fsynced
+static const int COMMIT_INTERVAL_MS = 100;
+
+// Commit early once this much is buffered
+static const int COMMIT_MAX_PENDING_BYTES = 64 * 1024;
+
+namespace SyncQueueFormat {
+
+void writeOperation(QCborStreamWriter& writer, const SyncOperation& op,
+                    const QHash<QString, int>* typeTable)
+{
+    writer.startArray(8);
+    writer.append(op.uuid);
+    if (typeTable && typeTable->contains(op.type)) {
+        writer.append(qint64(typeTable->value(op.type)));
+    } else {
+        writer.append(op.type);
+    }
+    writer.append(op.taskId);
+    writer.append(op.content);
+    writer.append(op.tempId);
+    writer.append(CborIO::toEpochMs(op.queuedAt));
+    writer.append(qint64(op.retryCount));
+    writer.append(op.closeAfterCreate);
+    writer.endArray();
+}
+
+bool readOperation(QCborStreamReader& reader, const QStringList& typeTable, SyncOperation* op)
+{
+    if (!reader.isArray() || !reader.enterContainer()) {
+        return false;
+    }
+
+    if (!CborIO::readString(reader, &op->uuid)) {
+        return false;
+    }
+
+    if (reader.isInteger()) {
+        qint64 typeIndex = -1;
+        if (!CborIO::readInteger(reader, &typeIndex) || typeIndex < 0 || typeIndex >= typeTable.size()) {
+            return false;
+        }
+        op->type = typeTable.at(typeIndex);
+    } else if (!CborIO::readString(reader, &op->type)) {
+        return false;
+    }
+
+    qint64 queuedAt = -1;
+    qint64 retryCount = 0;
+    if (!CborIO::readString(reader, &op->taskId)
+        || !CborIO::readString(reader, &op->content)
+        || !CborIO::readString(reader, &op->tempId)
+        || !CborIO::readInteger(reader, &queuedAt)
+        || !CborIO::readInteger(reader, &retryCount)) {
+        return false;
+    }
+    op->queuedAt = CborIO::fromEpochMs(queuedAt);
+    op->retryCount = static_cast<int>(retryCount);
+
+    if (reader.hasNext() && reader.isBool()) {
+        op->closeAfterCreate = reader.toBool();
+        reader.next();
+    }
+
+    // Tolerates trailing fields written by newer versions
+    return CborIO::leaveContainer(reader);
+}
+
+QByteArray operationRecord(LogRecordKind kind, const SyncOperation& op)
+{
+    QByteArray record;
+    QCborStreamWriter writer(&record);
+    writer.startArray(2);
+    writer.append(qint64(kind));
+    writeOperation(writer, op, nullptr);
+    writer.endArray();
+    return record;
+}
+
+QByteArray ackRecord(const QStringList& uuids)
+{
+    QByteArray record;
+    QCborStreamWriter writer(&record);
+    writer.startArray(1 + uuids.size());
+    writer.append(qint64(LogAck));
+    for (const QString& uuid : uuids) {
+        writer.append(uuid);
+    }
+    writer.endArray();
+    return record;
+}
+
+QByteArray generationRecord(quint64 generation)
+{
+    QByteArray record;
+    QCborStreamWriter writer(&record);
+    writer.startArray(2);
+    writer.append(qint64(LogGeneration));
+    writer.append(qint64(generation));
+    writer.endArray();
+    return record;
+}
+
+} // namespace SyncQueueFormat
+
+using namespace SyncQueueFormat;
+
+static bool ensureParentDirectory(const QString& filePath)
+{
+    QDir dir = QFileInfo(filePath).dir();
+    if (!dir.exists() && !dir.mkpath(".")) {
+        qWarning() << "Failed to create directory:" << dir.path();
+        return false;
+    }
+    return true;
+}
+
+SyncQueueWriter::SyncQueueWriter(const QString& snapshotPath, const QString& logPath, QObject* parent)
+    : QObject(parent)
+    , m_snapshotPath(snapshotPath)
+    , m_logPath(logPath)
+    , m_pendingSequence(0)
+    , m_failed(false)
+    , m_generation(0)
+    , m_stampLog(true)
+    , m_commitTimer(nullptr)
+{
+}
+
+void SyncQueueWriter::setGeneration(quint64 generation)
+{
+    m_generation = generation;
+    m_stampLog = true;
+}
+
+bool SyncQueueWriter::openLog()
+{
+    if (m_logFile.isOpen()) {
+        return true;
+    }
+
+    if (!ensureParentDirectory(m_logPath)) {
+        return false;
+    }
+
+    m_logFile.setFileName(m_logPath);
+    if (!m_logFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "Failed to open sync log:" << m_logPath << m_logFile.errorString();
+        return false;
+    }
+    return true;
+}
+
+void SyncQueueWriter::scheduleCommit()
+{
+    if (m_pending.size() >= COMMIT_MAX_PENDING_BYTES) {
+        commit();
+        return;
+    }
+
+    if (!m_commitTimer) {
+        m_commitTimer = new QTimer(this);
+        m_commitTimer->setSingleShot(true);
+        m_commitTimer->setInterval(COMMIT_INTERVAL_MS);
+        connect(m_commitTimer, &QTimer::timeout, this, &SyncQueueWriter::commit);
+    }
+
+    // Not restarted by later records, so the delay stays bounded
+    if (!m_commitTimer->isActive()) {
+        m_commitTimer->start();
+    }
+}
+
+void SyncQueueWriter::appendRecord(quint64 sequence, const QByteArray& record)
+{
+    m_pending.append(record);
+    m_pendingSequence = sequence;
+    scheduleCommit();
+}
+
+bool SyncQueueWriter::commit()
+{
+    if (m_commitTimer) {
+        m_commitTimer->stop();
+    }
+
+    if (!m_pending.isEmpty()) {
+        // Name the snapshot these records apply to
+        if (m_stampLog) {
+            m_pending.prepend(generationRecord(m_generation));
+        }
+        bool written = openLog()
+                       && m_logFile.write(m_pending) == m_pending.size()
+                       && m_logFile.flush()
+                       && ::fsync(m_logFile.handle()) == 0;
+        m_pending.clear();
+        m_stampLog = !written;
+
+        if (!written) {
+            // The log may now end in a torn record; a snapshot replaces it
+            qWarning() << "Failed to append to sync log:" << m_logFile.errorString();
+            m_failed = true;
+            emit logWriteFailed();
+            return false;
+        }
+
+        emit committed(m_pendingSequence);
+    }
+
+    bool ok = !m_failed;
+    m_failed = false;
+    return ok;
+}
+
+void SyncQueueWriter::writeSnapshot(quint64 sequence, const QVector<SyncOperation>& operations)
+{
+    if (!ensureParentDirectory(m_snapshotPath)) {
+        m_failed = true;
+        emit snapshotWriteFailed();
+        return;
+    }
+
+    // Write via a temporary file so a crash never leaves a half-written snapshot
+    QSaveFile file(m_snapshotPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to open file for writing:" << m_snapshotPath << file.errorString();
+        m_failed = true;
+        emit snapshotWriteFailed();
+        return;
+    }
+
+    // Operation types repeat on every record, so they go in a string table
+    QStringList types;
+    QHash<QString, int> typeTable;
+    for (const SyncOperation& op : operations) {
+        if (!typeTable.contains(op.type)) {
+            typeTable.insert(op.type, types.size());
+            types.append(op.type);
+        }
+    }
+
+    quint64 generation = m_generation + 1;
+    QCborStreamWriter writer(&file);
+    writer.startMap(4);
+    writer.append(QLatin1String("v"));
+    writer.append(SNAPSHOT_VERSION);
+    writer.append(QLatin1String("gen"));
+    writer.append(qint64(generation));
+    writer.append(QLatin1String("types"));
+    writer.startArray(types.size());
+    for (const QString& type : types) {
+        writer.append(type);
+    }
+    writer.endArray();
+    writer.append(QLatin1String("ops"));
+    writer.startArray(operations.size());
+    for (const SyncOperation& op : operations) {
+        writeOperation(writer, op, &typeTable);
+    }
+    writer.endArray();
+    writer.endMap();
+
+    // commit() syncs the temporary file before renaming it into place
+    if (!file.commit()) {
+        qWarning() << "Failed to write sync queue snapshot:" << m_snapshotPath << file.errorString();
+        m_failed = true;
+        emit snapshotWriteFailed();
+        return;  // Buffered records still go to the log on the next commit
+    }
+
+    // Everything still buffered is covered by the snapshot
+    m_generation = generation;
+    m_stampLog = true;
+    m_pending.clear();
+    if (m_commitTimer) {
+        m_commitTimer->stop();
+    }
+
+    // The snapshot now covers everything in the log. Should the truncation
+    // not happen (crash, failed resize), the old records carry an older
+    // generation and are skipped on load; later ones are stamped anew.
+    if (openLog() && !m_logFile.resize(0)) {
+        qWarning() << "Failed to truncate sync log:" << m_logFile.errorString();
+    }
+
+    qDebug() << "Saved" << operations.size() << "operations to" << m_snapshotPath;
+    emit committed(sequence);
+}
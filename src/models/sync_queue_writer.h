@@ -0,0 +1,98 @@
+#ifndef SYNC_QUEUE_WRITER_H
+#define SYNC_QUEUE_WRITER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QCborStreamReader>
+#include <QCborStreamWriter>
+#include <QFile>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+#include "sync_queue.h"
+
+class QTimer;
+
+// On-disk encoding shared by SyncQueue (reading) and SyncQueueWriter (writing)
+namespace SyncQueueFormat {
+
+// Snapshot format version (bump when the record layout changes)
+const qint64 SNAPSHOT_VERSION = 1;
+
+// Log record kinds: [kind, operation], [LogAck, uuid, uuid, ...] or
+// [LogGeneration, generation]. Records following a generation record only
+// apply on top of a snapshot of that generation (or an older one).
+enum LogRecordKind {
+    LogAdd = 0,
+    LogAck = 1,
+    LogUpdate = 2,
+    LogGeneration = 3
+};
+
+// An operation is a fixed-order CBOR array:
+//   [uuid, type, taskId, content, tempId, queuedAt (epoch ms), retryCount, closeAfterCreate]
+// Fields after retryCount were added later and are optional when reading.
+// In snapshots the type is an index into the snapshot's string table.
+void writeOperation(QCborStreamWriter& writer, const SyncOperation& op,
+                    const QHash<QString, int>* typeTable);
+bool readOperation(QCborStreamReader& reader, const QStringList& typeTable, SyncOperation* op);
+
+QByteArray operationRecord(LogRecordKind kind, const SyncOperation& op);
+QByteArray ackRecord(const QStringList& uuids);
+QByteArray generationRecord(quint64 generation);
+
+} // namespace SyncQueueFormat
+
+/**
+ * @brief Persistence worker for SyncQueue, living on its own thread.
+ *
+ * SyncQueue changes its in-memory state immediately and hands each log
+ * record to this worker. Records are buffered and group-committed: one
+ * write plus fsync at most COMMIT_INTERVAL_MS after the first pending
+ * record, so a burst of taps costs a single flush. Each record and
+ * snapshot carries the queue's sequence number for it; committed() reports
+ * the highest one on disk. Failures are reported through logWriteFailed()
+ * and snapshotWriteFailed().
+ *
+ * Every snapshot gets the next generation number, and the log started
+ * after it is stamped with the same one. A log left behind by a crash
+ * between a snapshot and the log truncation is older than the snapshot,
+ * so it is skipped on load instead of resurrecting acknowledged operations.
+ */
+class SyncQueueWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    SyncQueueWriter(const QString& snapshotPath, const QString& logPath, QObject* parent = nullptr);
+
+public slots:
+    // Generation of the snapshot on disk; set before anything is written
+    void setGeneration(quint64 generation);
+    void appendRecord(quint64 sequence, const QByteArray& record);
+    // Replaces the snapshot and truncates the log; covers every earlier record
+    void writeSnapshot(quint64 sequence, const QVector<SyncOperation>& operations);
+    // Write and fsync everything pending now; false if anything failed to persist
+    bool commit();
+
+signals:
+    void committed(quint64 sequence);  // Everything up to this sequence is on disk
+    void logWriteFailed();       // The log is unusable; the queue should snapshot
+    void snapshotWriteFailed();  // The old snapshot and log are still in place
+
+private:
+    bool openLog();
+    void scheduleCommit();
+
+    QString m_snapshotPath;
+    QString m_logPath;
+    QFile m_logFile;        // Kept open for appends
+    QByteArray m_pending;   // Records not yet written
+    quint64 m_pendingSequence;  // Sequence of the last record in m_pending
+    bool m_failed;          // A write failed since the last commit()
+    quint64 m_generation;   // Of the current snapshot, and of the log after it
+    bool m_stampLog;        // Next commit must start with a generation record
+    QTimer* m_commitTimer;  // Created on the worker thread
+};
+
+#endif // SYNC_QUEUE_WRITER_H
@@ -1,4 +1,5 @@
 #include "task.h"
+#include <QJsonArray>
 #include <QJsonValue>
 
 Task Task::fromJson(const QJsonObject& obj)
@@ -7,9 +8,10 @@ Task Task::fromJson(const QJsonObject& obj)
 
     task.id = obj["id"].toString();
     task.title = obj["content"].toString();
-    task.projectId = obj["project_id"].toString();
-    task.priority = obj["priority"].toInt(1);  // Default to 1 (lowest) if not present
-    task.completed = obj["is_completed"].toBool(false);
+    task.setProjectId(obj["project_id"].toString());
+    task.priority = qBound(1, obj["priority"].toInt(1), 4);  // Default to 1 (lowest) if not present
+    // REST API v2 uses "is_completed", Sync API items use "checked"
+    task.completed = obj["is_completed"].toBool(obj["checked"].toBool(false));
 
     // Parse due date if present
     QJsonValue dueValue = obj["due"];
@@ -21,6 +23,12 @@ Task Task::fromJson(const QJsonObject& obj)
         }
     }
 
+    QStringList labels;
+    for (const QJsonValue& label : obj["labels"].toArray()) {
+        labels.append(label.toString());
+    }
+    task.setLabels(labels);
+
     // Note: projectName will be filled in by the caller after matching with project data
 
     return task;
@@ -39,12 +47,12 @@ QString Task::priorityLabel() const
     }
 }
 
-QString Task::dueDateDisplay() const
+QString Task::formatDueDate(const QDate& date)
 {
-    if (!dueDate.isValid()) {
+    if (!date.isValid()) {
         return "";
     }
 
     // Format as "Mon, Jan 30" or similar readable format
-    return dueDate.toString("ddd, MMM d");
+    return date.toString("ddd, MMM d");
 }
@@ -2,29 +2,47 @@
 #define TASK_H
 
 #include <QString>
+#include <QStringList>
 #include <QDate>
 #include <QJsonObject>
+#include "string_table.h"
 
+// Fields are ordered largest first; project and label strings are interned
+// handles and the small fields are bit-packed (80 bytes on 64-bit builds)
 struct Task {
     QString id;
     QString title;
-    QString projectId;
-    QString projectName;
     QDate dueDate;
-    int priority;  // 1-4, where 4 is highest in Todoist API
-    bool completed;
+    StringTable::Handle projectIdHandle;
+    StringTable::Handle projectNameHandle;
+    StringTable::Handle labelsHandle;
+    int sourceOrder;  // Position in the API's ordering (set by the parser, kept by TaskModel)
+    quint8 priority : 3;  // 1-4, where 4 is highest in Todoist API
+    bool completed : 1;
 
     // Default constructor
-    Task() : priority(0), completed(false) {}
+    Task()
+        : projectIdHandle(0), projectNameHandle(0), labelsHandle(0)
+        , sourceOrder(0), priority(0), completed(false) {}
 
     // Parse from Todoist API JSON response
     static Task fromJson(const QJsonObject& obj);
 
+    const QString& projectId() const { return StringTable::value(projectIdHandle); }
+    void setProjectId(const QString& projectId) { projectIdHandle = StringTable::intern(projectId); }
+
+    const QString& projectName() const { return StringTable::value(projectNameHandle); }
+    void setProjectName(const QString& name) { projectNameHandle = StringTable::intern(name); }
+
+    QStringList labels() const { return StringTable::list(labelsHandle); }
+    void setLabels(const QStringList& labels) { labelsHandle = StringTable::internList(labels); }
+
     // Return priority label for display (P1-P4, where P1 is highest)
     QString priorityLabel() const;
 
     // Return formatted due date or empty string
-    QString dueDateDisplay() const;
+    QString dueDateDisplay() const { return formatDueDate(dueDate); }
+    static QString formatDueDate(const QDate& date);
 };
 
 #endif // TASK_H
@@ -0,0 +1,193 @@
+#include "task_search_index.h"
+
+QString TaskSearchIndex::normalize(const QString& text)
+{
+    // "Café" and "cafe" should find each other: decompose, drop the accents
+    QString decomposed = text.normalized(QString::NormalizationForm_KD);
+    QString stripped;
+    stripped.reserve(decomposed.size());
+    for (const QChar& c : decomposed) {
+        if (c.category() != QChar::Mark_NonSpacing) {
+            stripped.append(c);
+        }
+    }
+    return stripped.toCaseFolded().simplified();
+}
+
+QStringList TaskSearchIndex::terms(const QString& query)
+{
+    return normalize(query).split(' ', Qt::SkipEmptyParts);
+}
+
+QSet<quint64> TaskSearchIndex::trigrams(const QString& text)
+{
+    QSet<quint64> result;
+    for (int i = 0; i + 2 < text.size(); ++i) {
+        result.insert((quint64(text[i].unicode()) << 32)
+                      | (quint64(text[i + 1].unicode()) << 16)
+                      | quint64(text[i + 2].unicode()));
+    }
+    return result;
+}
+
+bool TaskSearchIndex::matchesTerms(const QString& text, const QStringList& terms)
+{
+    for (const QString& term : terms) {
+        if (!text.contains(term)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TaskSearchIndex::insert(const Task& task)
+{
+    auto it = m_entries.find(task.id);
+    if (it != m_entries.end()) {
+        if (it->title == task.title && it->projectName == task.projectNameHandle) {
+            return;
+        }
+        removePostings(task.id, it->text);
+    } else {
+        it = m_entries.insert(task.id, Entry());
+    }
+
+    it->title = task.title;
+    it->projectName = task.projectNameHandle;
+    it->text = normalize(task.title) + '\n' + normalize(task.projectName());
+    addPostings(task.id, it->text);
+
+    if (hasQuery()) {
+        if (matchesTerms(it->text, m_queryTerms)) {
+            m_matches.insert(task.id);
+        } else {
+            m_matches.remove(task.id);
+        }
+    }
+}
+
+void TaskSearchIndex::remove(const QString& taskId)
+{
+    auto it = m_entries.find(taskId);
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    removePostings(taskId, it->text);
+    m_entries.erase(it);
+    m_matches.remove(taskId);
+}
+
+void TaskSearchIndex::rename(const QString& oldId, const QString& newId)
+{
+    auto it = m_entries.find(oldId);
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    Entry entry = it.value();
+    removePostings(oldId, entry.text);
+    m_entries.erase(it);
+    addPostings(newId, entry.text);
+    m_entries.insert(newId, entry);
+
+    if (m_matches.remove(oldId)) {
+        m_matches.insert(newId);
+    }
+}
+
+void TaskSearchIndex::clear()
+{
+    m_entries.clear();
+    m_postings.clear();
+    m_matches.clear();
+}
+
+QSet<QString> TaskSearchIndex::search(const QString& query) const
+{
+    return searchTerms(terms(query), nullptr);
+}
+
+void TaskSearchIndex::setQuery(const QString& query)
+{
+    QString normalized = normalize(query);
+    if (normalized == m_query) {
+        return;
+    }
+
+    // Typing another character can only narrow the result, so filter the
+    // previous matches instead of searching the whole index again
+    bool narrowing = hasQuery() && normalized.startsWith(m_query);
+    QStringList queryTerms = normalized.split(' ', Qt::SkipEmptyParts);
+    m_matches = queryTerms.isEmpty() ? QSet<QString>()
+                                     : searchTerms(queryTerms, narrowing ? &m_matches : nullptr);
+    m_query = normalized;
+    m_queryTerms = queryTerms;
+}
+
+QSet<QString> TaskSearchIndex::searchTerms(const QStringList& terms, const QSet<QString>* within) const
+{
+    QSet<QString> result;
+
+    // Candidates from the trigram postings of terms long enough to have any
+    QSet<QString> candidates;
+    bool narrowed = false;
+    for (const QString& term : terms) {
+        for (quint64 trigram : trigrams(term)) {
+            auto posting = m_postings.constFind(trigram);
+            if (posting == m_postings.constEnd()) {
+                return result;  // No task contains this trigram
+            }
+            if (!narrowed) {
+                candidates = within ? *within & posting.value() : posting.value();
+                narrowed = true;
+            } else {
+                candidates &= posting.value();
+            }
+            if (candidates.isEmpty()) {
+                return result;
+            }
+        }
+    }
+
+    if (!narrowed) {
+        // Only one- and two-character terms: scan, which is fast at this scale
+        if (within) {
+            candidates = *within;
+        } else {
+            for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+                candidates.insert(it.key());
+            }
+        }
+    }
+
+    // Postings only say all trigrams occur somewhere; confirm the substrings
+    for (const QString& taskId : std::as_const(candidates)) {
+        auto entry = m_entries.constFind(taskId);
+        if (entry != m_entries.constEnd() && matchesTerms(entry->text, terms)) {
+            result.insert(taskId);
+        }
+    }
+    return result;
+}
+
+void TaskSearchIndex::addPostings(const QString& taskId, const QString& text)
+{
+    for (quint64 trigram : trigrams(text)) {
+        m_postings[trigram].insert(taskId);
+    }
+}
+
+void TaskSearchIndex::removePostings(const QString& taskId, const QString& text)
+{
+    for (quint64 trigram : trigrams(text)) {
+        auto posting = m_postings.find(trigram);
+        if (posting == m_postings.end()) {
+            continue;
+        }
+        posting->remove(taskId);
+        if (posting->isEmpty()) {
+            m_postings.erase(posting);
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef TASK_SEARCH_INDEX_H
+#define TASK_SEARCH_INDEX_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include "task.h"
+
+/**
+ * @brief In-memory trigram index over task titles and project names.
+ *
+ * Text is normalized (accents stripped, case folded, whitespace collapsed)
+ * and every three-character window maps to the IDs of the tasks containing
+ * it. A query term of three or more characters only looks at tasks found in
+ * all of its trigram posting sets; every candidate is then confirmed with a
+ * substring check, so results are exact. Terms are ANDed.
+ *
+ * TaskModel keeps the index current as tasks are added, changed and removed.
+ * One query can be active at a time; its match set is updated along with the
+ * index so a filter model can test rows in O(1).
+ */
+class TaskSearchIndex
+{
+public:
+    // Add or update a task; unchanged title and project are a no-op
+    void insert(const Task& task);
+    void remove(const QString& taskId);
+    void rename(const QString& oldId, const QString& newId);
+    void clear();
+
+    // IDs of all tasks matching the query (every task for an empty query)
+    QSet<QString> search(const QString& query) const;
+
+    // Active query
+    void setQuery(const QString& query);
+    bool hasQuery() const { return !m_queryTerms.isEmpty(); }
+    bool isMatch(const QString& taskId) const { return !hasQuery() || m_matches.contains(taskId); }
+    int matchCount() const { return hasQuery() ? m_matches.size() : m_entries.size(); }
+
+private:
+    struct Entry {
+        QString title;                    // As indexed, to detect changes
+        StringTable::Handle projectName;
+        QString text;                     // Normalized "title\nproject"
+    };
+
+    static QString normalize(const QString& text);
+    static QStringList terms(const QString& query);
+    static QSet<quint64> trigrams(const QString& text);
+    static bool matchesTerms(const QString& text, const QStringList& terms);
+
+    QSet<QString> searchTerms(const QStringList& terms, const QSet<QString>* within) const;
+    void addPostings(const QString& taskId, const QString& text);
+    void removePostings(const QString& taskId, const QString& text);
+
+    QHash<QString, Entry> m_entries;
+    QHash<quint64, QSet<QString>> m_postings;  // Trigram -> task IDs
+
+    QString m_query;        // Normalized
+    QStringList m_queryTerms;
+    QSet<QString> m_matches;
+};
+
+#endif // TASK_SEARCH_INDEX_H
@@ -0,0 +1,45 @@
+#include "task_search_model.h"
+#include "taskmodel.h"
+#include <QDebug>
+#include <QElapsedTimer>
+
+TaskSearchModel::TaskSearchModel(TaskModel* tasks, QObject* parent)
+    : QSortFilterProxyModel(parent)
+    , m_tasks(tasks)
+{
+    setSourceModel(tasks);
+
+    connect(this, &QAbstractItemModel::rowsInserted, this, &TaskSearchModel::countChanged);
+    connect(this, &QAbstractItemModel::rowsRemoved, this, &TaskSearchModel::countChanged);
+    connect(this, &QAbstractItemModel::modelReset, this, &TaskSearchModel::countChanged);
+    connect(this, &QAbstractItemModel::layoutChanged, this, &TaskSearchModel::countChanged);
+}
+
+void TaskSearchModel::setQuery(const QString& query)
+{
+    if (query == m_query) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    m_query = query;
+    m_tasks->setSearchQuery(query);
+
+    // Matches can be anywhere in the list, not just in the fetched pages
+    m_tasks->setExposeAll(this, !query.isEmpty());
+    invalidateFilter();
+
+    qDebug() << "Search for" << query << "matched" << rowCount() << "tasks in"
+             << timer.nsecsElapsed() / 1000 << "us";
+
+    emit queryChanged();
+    emit countChanged();
+}
+
+bool TaskSearchModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const
+{
+    Q_UNUSED(sourceParent);
+    return m_tasks->isSearchMatch(sourceRow);
+}
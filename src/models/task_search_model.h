@@ -0,0 +1,46 @@
+#ifndef TASK_SEARCH_MODEL_H
+#define TASK_SEARCH_MODEL_H
+
+#include <QSortFilterProxyModel>
+#include <QString>
+
+class TaskModel;
+
+/**
+ * @brief Filtered view of TaskModel for the search screen.
+ *
+ * Rows are those matching the query according to TaskModel's search index,
+ * in the task list's current order. While the query is non-empty all of
+ * TaskModel's rows stay exposed, since matches are not limited to the
+ * fetched pages; clearing it returns TaskModel to paging. Setting the query
+ * asks the index for the match set once; filtering each row is then a hash
+ * lookup. Tasks that change while a query is active are re-matched by the
+ * index as part of the same model update.
+ */
+class TaskSearchModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+    Q_PROPERTY(QString query READ query WRITE setQuery NOTIFY queryChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    explicit TaskSearchModel(TaskModel* tasks, QObject* parent = nullptr);
+
+    QString query() const { return m_query; }
+    void setQuery(const QString& query);
+
+    int count() const { return rowCount(); }
+
+signals:
+    void queryChanged();
+    void countChanged();
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+
+private:
+    TaskModel* m_tasks;
+    QString m_query;
+};
+
+#endif // TASK_SEARCH_MODEL_H
@@ -0,0 +1,232 @@
+#include "task_snapshot.h"
+#include "cbor_io.h"
+#include <QCborStreamReader>
+#include <QCborStreamWriter>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+
+static const qint64 SNAPSHOT_VERSION = 1;
+
+// Fields per task record
+static const int TASK_FIELDS = 7;
+
+static void writeTask(QCborStreamWriter& writer, const Task& task, const QHash<QString, int>& projectTable)
+{
+    writer.startArray(TASK_FIELDS);
+    writer.append(task.id);
+    writer.append(task.title);
+    QString projectId = task.projectId();
+    if (projectTable.contains(projectId)) {
+        writer.append(qint64(projectTable.value(projectId)));
+    } else {
+        writer.append(projectId);
+    }
+    writer.append(task.dueDate.isValid() ? task.dueDate.toJulianDay() : qint64(-1));
+    writer.append(qint64(task.priority));
+    writer.append(bool(task.completed));
+    QStringList labels = task.labels();
+    writer.startArray(labels.size());
+    for (const QString& label : labels) {
+        writer.append(label);
+    }
+    writer.endArray();
+    writer.endArray();
+}
+
+static bool readTask(QCborStreamReader& reader, const QStringList& projectIds, Task* task)
+{
+    if (!reader.isArray() || !reader.enterContainer()) {
+        return false;
+    }
+
+    qint64 dueDay = -1;
+    qint64 priority = 0;
+    if (!CborIO::readString(reader, &task->id) || !CborIO::readString(reader, &task->title)) {
+        return false;
+    }
+
+    if (reader.isInteger()) {
+        qint64 index = 0;
+        if (!CborIO::readInteger(reader, &index) || index < 0 || index >= projectIds.size()) {
+            return false;
+        }
+        task->setProjectId(projectIds.at(index));
+    } else {
+        QString projectId;
+        if (!CborIO::readString(reader, &projectId)) {
+            return false;
+        }
+        task->setProjectId(projectId);
+    }
+
+    if (!CborIO::readInteger(reader, &dueDay) || !CborIO::readInteger(reader, &priority)) {
+        return false;
+    }
+    task->dueDate = dueDay < 0 ? QDate() : QDate::fromJulianDay(dueDay);
+    task->priority = qBound(0, int(priority), 4);
+
+    if (!reader.isBool()) {
+        return false;
+    }
+    task->completed = reader.toBool();
+    reader.next();
+
+    if (!reader.isArray() || !reader.enterContainer()) {
+        return false;
+    }
+    QStringList labels;
+    QString label;
+    while (reader.hasNext() && CborIO::readString(reader, &label)) {
+        labels.append(label);
+    }
+    if (!reader.leaveContainer()) {
+        return false;
+    }
+    task->setLabels(labels);
+
+    return CborIO::leaveContainer(reader);  // Fields from a newer version
+}
+
+QString TaskSnapshot::defaultFilePath()
+{
+    QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    return appDataPath + "/tasks.cbor";
+}
+
+bool TaskSnapshot::load(const QString& filePath, TaskSnapshot* out)
+{
+    MappedFile mapped;
+    if (!mapped.open(filePath)) {
+        qWarning() << "Failed to open file for reading:" << filePath << mapped.errorString();
+        return false;
+    }
+
+    QCborStreamReader reader(mapped.data());
+    if (!reader.isMap() || !reader.enterContainer()) {
+        qWarning() << "Expected CBOR map in task snapshot";
+        return false;
+    }
+
+    TaskSnapshot snapshot;
+    QStringList projectIds;
+    bool ok = true;
+    while (ok && reader.lastError() == QCborError::NoError && reader.hasNext()) {
+        QString key;
+        if (!CborIO::readString(reader, &key)) {
+            ok = false;
+            break;
+        }
+
+        if (key == "v") {
+            qint64 version = 0;
+            ok = CborIO::readInteger(reader, &version);
+            if (ok && version > SNAPSHOT_VERSION) {
+                qWarning() << "Task snapshot has unsupported version" << version;
+                return false;
+            }
+        } else if (key == "token") {
+            ok = CborIO::readString(reader, &snapshot.syncToken);
+        } else if (key == "saved") {
+            qint64 savedMs = -1;
+            ok = CborIO::readInteger(reader, &savedMs);
+            snapshot.savedAt = CborIO::fromEpochMs(savedMs);
+        } else if (key == "projects") {
+            ok = reader.isArray() && reader.enterContainer();
+            QString id;
+            QString name;
+            while (ok && reader.hasNext()) {
+                ok = CborIO::readString(reader, &id) && CborIO::readString(reader, &name);
+                if (ok) {
+                    projectIds.append(id);
+                    snapshot.projectNames.insert(id, name);
+                }
+            }
+            ok = ok && reader.leaveContainer();
+        } else if (key == "tasks") {
+            ok = reader.isArray() && reader.enterContainer();
+            if (ok && reader.isLengthKnown()) {
+                snapshot.tasks.reserve(static_cast<int>(reader.length()));
+            }
+            while (ok && reader.hasNext()) {
+                Task task;
+                ok = readTask(reader, projectIds, &task);
+                if (ok) {
+                    task.sourceOrder = snapshot.tasks.size();  // Saved in API order
+                    snapshot.tasks.append(task);
+                }
+            }
+            ok = ok && reader.leaveContainer();
+        } else {
+            reader.next();  // Field from a newer version
+        }
+    }
+
+    if (!ok || reader.lastError() != QCborError::NoError || !reader.leaveContainer()) {
+        qWarning() << "Failed to parse task snapshot:" << reader.lastError().toString();
+        return false;
+    }
+
+    // Project names are resolved here rather than stored per task
+    QHash<StringTable::Handle, StringTable::Handle> nameHandles;
+    for (auto it = snapshot.projectNames.cbegin(); it != snapshot.projectNames.cend(); ++it) {
+        nameHandles.insert(StringTable::intern(it.key()), StringTable::intern(it.value()));
+    }
+    for (Task& task : snapshot.tasks) {
+        task.projectNameHandle = nameHandles.value(task.projectIdHandle, 0);
+    }
+
+    *out = snapshot;
+    return true;
+}
+
+bool TaskSnapshot::save(const QString& filePath, const TaskSnapshot& snapshot)
+{
+    QDir dir = QFileInfo(filePath).dir();
+    if (!dir.exists() && !dir.mkpath(".")) {
+        qWarning() << "Failed to create directory:" << dir.path();
+        return false;
+    }
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to open file for writing:" << filePath << file.errorString();
+        return false;
+    }
+
+    QHash<QString, int> projectTable;
+    projectTable.reserve(snapshot.projectNames.size());
+
+    QCborStreamWriter writer(&file);
+    writer.startMap(5);
+    writer.append(QLatin1String("v"));
+    writer.append(SNAPSHOT_VERSION);
+    writer.append(QLatin1String("token"));
+    writer.append(snapshot.syncToken);
+    writer.append(QLatin1String("saved"));
+    writer.append(CborIO::toEpochMs(snapshot.savedAt));
+    writer.append(QLatin1String("projects"));
+    writer.startArray(snapshot.projectNames.size() * 2);
+    for (auto it = snapshot.projectNames.cbegin(); it != snapshot.projectNames.cend(); ++it) {
+        projectTable.insert(it.key(), projectTable.size());
+        writer.append(it.key());
+        writer.append(it.value());
+    }
+    writer.endArray();
+    writer.append(QLatin1String("tasks"));
+    writer.startArray(snapshot.tasks.size());
+    for (const Task& task : snapshot.tasks) {
+        writeTask(writer, task, projectTable);
+    }
+    writer.endArray();
+    writer.endMap();
+
+    if (!file.commit()) {
+        qWarning() << "Failed to write task snapshot:" << filePath << file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef TASK_SNAPSHOT_H
+#define TASK_SNAPSHOT_H
+
+#include <QDateTime>
+#include <QMap>
+#include <QString>
+#include <QVector>
+#include "task.h"
+
+/**
+ * @brief Last known task and project set, persisted for offline startup.
+ *
+ * Stored as one CBOR map at AppDataLocation/tasks.cbor:
+ *   {"v": 1, "token": syncToken, "saved": epochMs,
+ *    "projects": [id, name, id, name, ...],
+ *    "tasks": [[id, title, project, dueJulianDay, priority, completed, [labels]], ...]}
+ *
+ * A task's project is an index into "projects", or the project ID string
+ * for a project whose name is unknown. Tasks are kept in API order.
+ * load() decodes straight from a memory-mapped file; save() writes through
+ * QSaveFile so a crash leaves the previous snapshot intact.
+ */
+struct TaskSnapshot {
+    QVector<Task> tasks;                 // API order
+    QMap<QString, QString> projectNames; // projectId -> projectName
+    QString syncToken;                   // Sync API token the tasks correspond to (may be empty)
+    QDateTime savedAt;
+
+    static QString defaultFilePath();
+
+    static bool load(const QString& filePath, TaskSnapshot* out);
+    static bool save(const QString& filePath, const TaskSnapshot& snapshot);
+};
+
+#endif // TASK_SNAPSHOT_H
@@ -0,0 +1,247 @@
+#include "task_store.h"
+#include <iterator>
+
+// Todoist priority 4 is shown as P1
+static const int P1_PRIORITY = 4;
+
+// Length of the Upcoming view, starting tomorrow
+static const int UPCOMING_DAYS = 7;
+
+TaskStore::TaskStore()
+    : m_today(QDate::currentDate().toJulianDay())
+    , m_view(AllView)
+    , m_viewProject(0)
+    , m_batchDepth(0)
+    , m_changed(false)
+{
+}
+
+void TaskStore::upsert(const Task& task)
+{
+    if (task.completed) {
+        remove(task.id);
+        return;
+    }
+
+    Keys keys;
+    keys.dueDay = task.dueDate.isValid() ? task.dueDate.toJulianDay() : -1;
+    keys.priority = task.priority;
+    keys.project = task.projectIdHandle;
+
+    auto it = m_keys.find(task.id);
+    if (it != m_keys.end()) {
+        const Keys& old = it.value();
+        if (old.dueDay == keys.dueDay && old.priority == keys.priority && old.project == keys.project) {
+            return;
+        }
+        removeKeys(task.id, old);
+        it.value() = keys;
+    } else {
+        m_keys.insert(task.id, keys);
+    }
+
+    insertKeys(task.id, keys);
+    updateMatch(task.id, keys);
+    m_changed = true;
+}
+
+void TaskStore::remove(const QString& taskId)
+{
+    auto it = m_keys.find(taskId);
+    if (it == m_keys.end()) {
+        return;
+    }
+
+    removeKeys(taskId, it.value());
+    m_keys.erase(it);
+    m_matches.remove(taskId);
+    m_changed = true;
+}
+
+void TaskStore::rename(const QString& oldId, const QString& newId)
+{
+    auto it = m_keys.find(oldId);
+    if (it == m_keys.end()) {
+        return;
+    }
+
+    Keys keys = it.value();
+    removeKeys(oldId, keys);
+    m_keys.erase(it);
+    m_matches.remove(oldId);
+
+    m_keys.insert(newId, keys);
+    insertKeys(newId, keys);
+    updateMatch(newId, keys);
+}
+
+void TaskStore::beginBatch()
+{
+    if (m_batchDepth++ == 0) {
+        m_changed = false;
+    }
+}
+
+bool TaskStore::endBatch()
+{
+    if (m_batchDepth == 0 || --m_batchDepth > 0) {
+        return false;  // The outermost batch reports for all of it
+    }
+    return m_changed;
+}
+
+void TaskStore::dueRange(View view, qint64* first, qint64* last) const
+{
+    switch (view) {
+        case TodayView:
+            *first = m_today;
+            *last = m_today + 1;
+            break;
+        case OverdueView:
+            *first = 0;
+            *last = m_today;
+            break;
+        case UpcomingView:
+            *first = m_today + 1;
+            *last = m_today + 1 + UPCOMING_DAYS;
+            break;
+        default:
+            *first = 0;
+            *last = 0;
+            break;
+    }
+}
+
+QSet<QString> TaskStore::query(View view, StringTable::Handle project) const
+{
+    QSet<QString> result;
+    switch (view) {
+        case AllView:
+            for (auto it = m_keys.cbegin(); it != m_keys.cend(); ++it) {
+                result.insert(it.key());
+            }
+            break;
+        case TodayView:
+        case OverdueView:
+        case UpcomingView: {
+            qint64 first = 0;
+            qint64 last = 0;
+            dueRange(view, &first, &last);
+            auto end = m_byDue.lower_bound({last, QString()});
+            for (auto it = m_byDue.lower_bound({first, QString()}); it != end; ++it) {
+                result.insert(it->second);
+            }
+            break;
+        }
+        case PriorityView:
+            for (auto it = m_byPriority.lower_bound({P1_PRIORITY, QString()}); it != m_byPriority.end(); ++it) {
+                result.insert(it->second);
+            }
+            break;
+        case ProjectView: {
+            auto end = m_byProject.lower_bound({project + 1, QString()});
+            for (auto it = m_byProject.lower_bound({project, QString()}); it != end; ++it) {
+                result.insert(it->second);
+            }
+            break;
+        }
+    }
+    return result;
+}
+
+int TaskStore::count(View view, StringTable::Handle project) const
+{
+    switch (view) {
+        case AllView:
+            return m_keys.size();
+        case TodayView:
+        case OverdueView:
+        case UpcomingView: {
+            qint64 first = 0;
+            qint64 last = 0;
+            dueRange(view, &first, &last);
+            return static_cast<int>(std::distance(m_byDue.lower_bound({first, QString()}),
+                                                  m_byDue.lower_bound({last, QString()})));
+        }
+        case PriorityView:
+            return static_cast<int>(std::distance(m_byPriority.lower_bound({P1_PRIORITY, QString()}),
+                                                  m_byPriority.end()));
+        case ProjectView:
+            return static_cast<int>(std::distance(m_byProject.lower_bound({project, QString()}),
+                                                  m_byProject.lower_bound({project + 1, QString()})));
+    }
+    return 0;
+}
+
+void TaskStore::setToday(const QDate& today)
+{
+    qint64 day = today.toJulianDay();
+    if (day == m_today) {
+        return;
+    }
+
+    m_today = day;
+    if (m_view == TodayView || m_view == OverdueView || m_view == UpcomingView) {
+        m_matches = query(m_view, m_viewProject);
+    }
+    m_changed = true;
+}
+
+void TaskStore::setActiveView(View view, StringTable::Handle project)
+{
+    m_view = view;
+    m_viewProject = project;
+    m_matches = view == AllView ? QSet<QString>() : query(view, project);
+}
+
+bool TaskStore::inView(const Keys& keys, View view, StringTable::Handle project) const
+{
+    switch (view) {
+        case AllView:
+            return true;
+        case TodayView:
+        case OverdueView:
+        case UpcomingView: {
+            qint64 first = 0;
+            qint64 last = 0;
+            dueRange(view, &first, &last);
+            return keys.dueDay >= 0 && keys.dueDay >= first && keys.dueDay < last;
+        }
+        case PriorityView:
+            return keys.priority == P1_PRIORITY;
+        case ProjectView:
+            return keys.project == project;
+    }
+    return false;
+}
+
+void TaskStore::insertKeys(const QString& taskId, const Keys& keys)
+{
+    if (keys.dueDay >= 0) {
+        m_byDue.insert({keys.dueDay, taskId});
+    }
+    m_byPriority.insert({keys.priority, taskId});
+    m_byProject.insert({keys.project, taskId});
+}
+
+void TaskStore::removeKeys(const QString& taskId, const Keys& keys)
+{
+    if (keys.dueDay >= 0) {
+        m_byDue.erase({keys.dueDay, taskId});
+    }
+    m_byPriority.erase({keys.priority, taskId});
+    m_byProject.erase({keys.project, taskId});
+}
+
+void TaskStore::updateMatch(const QString& taskId, const Keys& keys)
+{
+    if (m_view == AllView) {
+        return;
+    }
+
+    if (inView(keys, m_view, m_viewProject)) {
+        m_matches.insert(taskId);
+    } else {
+        m_matches.remove(taskId);
+    }
+}
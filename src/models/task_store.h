@@ -0,0 +1,93 @@
+#ifndef TASK_STORE_H
+#define TASK_STORE_H
+
+#include <QDate>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <set>
+#include <utility>
+#include "task.h"
+
+/**
+ * @brief Secondary indexes over the task list for the smart views.
+ *
+ * Keeps ordered indexes (std::set, a balanced tree) on due date, priority
+ * and project, keyed by task ID, so Today, Overdue, Upcoming, P1 and
+ * per-project views are range lookups instead of a scan of every task.
+ * The tasks themselves stay in TaskModel; the store only holds their keys.
+ * Completed tasks (ticked, waiting for sync) are left out of every view.
+ *
+ * Updates take effect immediately. Between beginBatch() and endBatch()
+ * they are only grouped for reporting: endBatch() says whether anything
+ * changed, so listeners hear about a whole refresh or delta once rather
+ * than per task. Nothing is rolled back.
+ *
+ * Like TaskSearchIndex, one view can be active; its match set is kept
+ * current on every change so a filter model can test rows in O(1).
+ */
+class TaskStore
+{
+public:
+    enum View {
+        AllView,
+        TodayView,      // Due today
+        OverdueView,    // Due before today
+        UpcomingView,   // Due in the next seven days
+        PriorityView,   // P1 (Todoist priority 4)
+        ProjectView     // One project, given by handle
+    };
+
+    TaskStore();
+
+    void upsert(const Task& task);
+    void remove(const QString& taskId);
+    void rename(const QString& oldId, const QString& newId);
+
+    void beginBatch();
+    bool endBatch();  // True if anything changed since beginBatch()
+
+    QSet<QString> query(View view, StringTable::Handle project = 0) const;
+    int count(View view, StringTable::Handle project = 0) const;
+
+    // Date the relative views are computed against
+    void setToday(const QDate& today);
+
+    // Active view
+    void setActiveView(View view, StringTable::Handle project = 0);
+    View activeView() const { return m_view; }
+    bool isMatch(const QString& taskId) const { return m_view == AllView || m_matches.contains(taskId); }
+
+private:
+    struct Keys {
+        qint64 dueDay;  // Julian day, or -1 if undated
+        int priority;
+        StringTable::Handle project;
+    };
+
+    using DueIndex = std::set<std::pair<qint64, QString>>;
+    using PriorityIndex = std::set<std::pair<int, QString>>;
+    using ProjectIndex = std::set<std::pair<StringTable::Handle, QString>>;
+
+    // [first, last) Julian days for the date-based views
+    void dueRange(View view, qint64* first, qint64* last) const;
+    bool inView(const Keys& keys, View view, StringTable::Handle project) const;
+    void insertKeys(const QString& taskId, const Keys& keys);
+    void removeKeys(const QString& taskId, const Keys& keys);
+    void updateMatch(const QString& taskId, const Keys& keys);
+
+    QHash<QString, Keys> m_keys;
+    DueIndex m_byDue;  // Dated tasks only
+    PriorityIndex m_byPriority;
+    ProjectIndex m_byProject;
+
+    qint64 m_today;
+    View m_view;
+    StringTable::Handle m_viewProject;
+    QSet<QString> m_matches;
+
+    int m_batchDepth;
+    bool m_changed;
+};
+
+#endif // TASK_STORE_H
@@ -0,0 +1,55 @@
+#include "task_view_model.h"
+#include "taskmodel.h"
+#include <QDebug>
+#include <QElapsedTimer>
+
+TaskViewModel::TaskViewModel(TaskModel* tasks, QObject* parent)
+    : QSortFilterProxyModel(parent)
+    , m_tasks(tasks)
+{
+    setSourceModel(tasks);
+
+    connect(tasks, &TaskModel::viewMatchesChanged, this, &TaskViewModel::onViewMatchesChanged);
+    connect(this, &QAbstractItemModel::rowsInserted, this, &TaskViewModel::countChanged);
+    connect(this, &QAbstractItemModel::rowsRemoved, this, &TaskViewModel::countChanged);
+    connect(this, &QAbstractItemModel::modelReset, this, &TaskViewModel::countChanged);
+    connect(this, &QAbstractItemModel::layoutChanged, this, &TaskViewModel::countChanged);
+}
+
+QString TaskViewModel::view() const
+{
+    return m_tasks->view();
+}
+
+void TaskViewModel::setView(const QString& view)
+{
+    if (view == m_tasks->view()) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    m_tasks->setView(view);  // Re-filters through viewMatchesChanged
+
+    // Matches can be anywhere in the list, not just in the fetched pages,
+    // including in tasks loaded after this (e.g. a view restored at startup)
+    m_tasks->setExposeAll(this, m_tasks->view() != "all");
+
+    qDebug() << "View" << m_tasks->view() << "has" << rowCount() << "tasks, switched in"
+             << timer.nsecsElapsed() / 1000 << "us";
+
+    emit viewChanged();
+}
+
+void TaskViewModel::onViewMatchesChanged()
+{
+    invalidateFilter();
+    emit countChanged();
+}
+
+bool TaskViewModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const
+{
+    Q_UNUSED(sourceParent);
+    return m_tasks->isViewMatch(sourceRow);
+}
@@ -0,0 +1,46 @@
+#ifndef TASK_VIEW_MODEL_H
+#define TASK_VIEW_MODEL_H
+
+#include <QSortFilterProxyModel>
+#include <QString>
+
+class TaskModel;
+
+/**
+ * @brief TaskModel filtered to one smart view, for the main task list.
+ *
+ * "all" passes every row through, so paging with fetchMore() still works.
+ * Any other view ("today", "overdue", "upcoming", "p1", "project:<id>")
+ * takes its match set from TaskModel's store and keeps all source rows
+ * exposed while it is active, loads and deltas included, since matches can
+ * be anywhere in the list; filtering a row is then a hash lookup.
+ */
+class TaskViewModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+    Q_PROPERTY(QString view READ view WRITE setView NOTIFY viewChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    explicit TaskViewModel(TaskModel* tasks, QObject* parent = nullptr);
+
+    QString view() const;
+    void setView(const QString& view);
+
+    int count() const { return rowCount(); }
+
+signals:
+    void viewChanged();
+    void countChanged();
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+
+private slots:
+    void onViewMatchesChanged();
+
+private:
+    TaskModel* m_tasks;
+};
+
+#endif // TASK_VIEW_MODEL_H
@@ -1,8 +1,45 @@
 #include "taskmodel.h"
+#include <QDebug>
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
+#include <QPair>
+#include <algorithm>
+
+// Todoist priority 1-4 -> display label; index 0 is "no priority"
+static const QString PRIORITY_LABELS[] = {
+    QString(), QStringLiteral("P4"), QStringLiteral("P3"), QStringLiteral("P2"), QStringLiteral("P1")
+};
+
+// Rows exposed per fetchMore() until setPageSize() is called
+static const int DEFAULT_PAGE_SIZE = 50;
+
+// Smart view names, and the prefix for a single project's view
+static const QString VIEW_NAMES[] = {
+    QStringLiteral("all"), QStringLiteral("today"), QStringLiteral("overdue"),
+    QStringLiteral("upcoming"), QStringLiteral("p1")
+};
+static const QString PROJECT_VIEW_PREFIX = QStringLiteral("project:");
+
+static QString priorityLabel(int priority)
+{
+    return priority >= 0 && priority <= 4 ? PRIORITY_LABELS[priority] : QString();
+}
 
 TaskModel::TaskModel(QObject *parent)
     : QAbstractListModel(parent)
+    , m_sortMode(ApiOrder)
+    , m_nextSourceOrder(0)
+    , m_firstSourceOrder(0)
+    , m_exposedRows(0)
+    , m_pageSize(DEFAULT_PAGE_SIZE)
+    , m_rowBase(0)
+    , m_today(QDate::currentDate())
+    , m_view(VIEW_NAMES[TaskStore::AllView])
 {
+    m_midnightTimer.setSingleShot(true);
+    connect(&m_midnightTimer, &QTimer::timeout, this, &TaskModel::rollOverDay);
+    scheduleMidnight();
 }
 
 int TaskModel::rowCount(const QModelIndex &parent) const
@@ -10,12 +47,55 @@ int TaskModel::rowCount(const QModelIndex &parent) const
     if (parent.isValid()) {
         return 0;
     }
-    return m_tasks.size();
+    return m_exposedRows;
+}
+
+bool TaskModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_exposedRows < m_tasks.size();
+}
+
+void TaskModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid()) {
+        return;
+    }
+    exposeRows(m_exposedRows + m_pageSize);
+}
+
+void TaskModel::setExposeAll(const QObject* holder, bool exposeAll)
+{
+    if (exposeAll) {
+        m_exposeAllHolders.insert(holder);
+        exposeRows(m_tasks.size());
+        return;
+    }
+
+    if (m_exposeAllHolders.remove(holder) && m_exposeAllHolders.isEmpty()) {
+        hideRowsFrom(m_pageSize);
+    }
+}
+
+int TaskModel::pageSize() const
+{
+    return m_pageSize;
+}
+
+void TaskModel::setPageSize(int pageSize)
+{
+    pageSize = qMax(1, pageSize);
+    if (pageSize == m_pageSize) {
+        return;
+    }
+
+    m_pageSize = pageSize;
+    exposeRows(m_pageSize);  // A bigger first page applies right away
+    emit pageSizeChanged();
 }
 
 QVariant TaskModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || index.row() >= m_tasks.size()) {
+    if (!index.isValid() || index.row() >= m_exposedRows) {
         return QVariant();
     }
 
@@ -27,13 +107,21 @@ QVariant TaskModel::data(const QModelIndex &index, int role) const
         case TitleRole:
             return task.title;
         case DueDateRole:
-            return task.dueDateDisplay();
+            return dueDateText(task.dueDate);
         case ProjectNameRole:
-            return task.projectName;
+            return task.projectName();
         case PriorityRole:
-            return task.priority;  // Return numeric priority for QML
+            return int(task.priority);  // Return numeric priority for QML
         case CompletedRole:
             return task.completed;
+        case SectionRole:
+            return sectionFor(task);
+        case LabelsRole:
+            return task.labels();
+        case PriorityLabelRole:
+            return priorityLabel(task.priority);
+        case MetadataRole:
+            return metadataText(task);
         case Qt::DisplayRole:
             return task.title;
         default:
@@ -50,14 +138,249 @@ QHash<int, QByteArray> TaskModel::roleNames() const
     roles[ProjectNameRole] = "projectName";
     roles[PriorityRole] = "priority";
     roles[CompletedRole] = "completed";
+    roles[SectionRole] = "section";
+    roles[LabelsRole] = "labels";
+    roles[PriorityLabelRole] = "priorityLabel";
+    roles[MetadataRole] = "metadata";
     return roles;
 }
 
 void TaskModel::setTasks(const QVector<Task> &tasks)
 {
-    beginResetModel();
+    // Shares the data; only a list that actually needs re-sorting is copied
+    setTasks(QVector<Task>(tasks));
+}
+
+void TaskModel::setTasks(QVector<Task> &&tasks)
+{
+    // Bring the list into display order; sourceOrder keeps the API order
+    auto less = [this](const Task& a, const Task& b) {
+        return lessThan(a, b);
+    };
+    if (m_sortMode != ApiOrder && !std::is_sorted(tasks.cbegin(), tasks.cend(), less)) {
+        std::stable_sort(tasks.begin(), tasks.end(), less);
+    }
+    m_nextSourceOrder = tasks.size();
+    adoptTasks(tasks);
+}
+
+void TaskModel::adoptTasks(const QVector<Task> &tasks)
+{
+    m_store.beginBatch();
+
+    // Start the display caches over so they only hold the current list's
+    // values; index incoming tasks before any row signal reaches a filter
+    m_dueDateText.clear();
+    m_metadataText.clear();
+    for (const Task& task : tasks) {
+        taskChanged(task);
+    }
+
+    // Keyed diff instead of a model reset: an unchanged refresh emits nothing,
+    // so QML keeps every delegate and the e-ink panel isn't redrawn
+    QSet<QString> newIds;
+    newIds.reserve(tasks.size());
+    for (const Task& task : tasks) {
+        newIds.insert(task.id);
+    }
+
+    // 1. Remove rows that are gone, bottom up, one signal per contiguous run
+    int removed = 0;
+    for (int last = m_tasks.size() - 1; last >= 0; --last) {
+        if (newIds.contains(m_tasks[last].id)) {
+            continue;
+        }
+        int first = last;
+        while (first > 0 && !newIds.contains(m_tasks[first - 1].id)) {
+            --first;
+        }
+        removeTaskRows(first, last);
+        removed += last - first + 1;
+        last = first;
+    }
+
+    QSet<QString> existing;
+    existing.reserve(m_tasks.size());
+    for (const Task& task : m_tasks) {
+        existing.insert(task.id);
+    }
+
+    // 2. Reorder survivors. Those on the longest run already in the right
+    // relative order stay put; every other one moves exactly once, to just
+    // after the survivor that precedes it in the new order
+    QSet<QString> stable = stableTaskIds(tasks);
+    int moved = 0;
+    for (int i = 0; i < tasks.size(); ++i) {
+        if (stable.contains(tasks[i].id) || !existing.contains(tasks[i].id)) {
+            continue;
+        }
+
+        int target = 0;
+        for (int p = i - 1; p >= 0; --p) {
+            if (existing.contains(tasks[p].id)) {
+                target = rowForId(tasks[p].id) + 1;
+                break;
+            }
+        }
+
+        int row = rowForId(tasks[i].id);
+        if (row != target) {
+            moveTaskRow(row, target);
+            ++moved;
+        }
+    }
+
+    // 3. Insert new tasks in place, one signal per contiguous run
+    QVector<QPair<int, int>> runs;
+    for (int first = 0; first < tasks.size(); ++first) {
+        if (existing.contains(tasks[first].id)) {
+            continue;
+        }
+        int last = first;
+        while (last + 1 < tasks.size() && !existing.contains(tasks[last + 1].id)) {
+            ++last;
+        }
+        runs.append(qMakePair(first, last));
+        first = last;
+    }
+
+    int inserted = 0;
+    if (runs.size() == 1) {
+        inserted = runs[0].second - runs[0].first + 1;
+        insertTaskRows(runs[0].first, tasks.mid(runs[0].first, inserted));
+    } else if (!runs.isEmpty()) {
+        // Many runs: shifting the index per run would cost O(runs x rows),
+        // so it is rebuilt once. Runs views can see still get a signal
+        // each; everything from the first hidden run on is spliced in one pass
+        int run = 0;
+        for (; run < runs.size(); ++run) {
+            int first = runs[run].first;
+            if (first >= m_exposedRows && m_exposeAllHolders.isEmpty()) {
+                break;  // Later runs start further down, so they are hidden too
+            }
+            int count = runs[run].second - first + 1;
+            insertTaskRows(first, tasks.mid(first, count), false);
+            inserted += count;
+        }
+
+        if (run < runs.size()) {
+            int first = runs[run].first;
+            QVector<Task> survivors = m_tasks.mid(first);
+            m_tasks.resize(first);
+            m_tasks.reserve(tasks.size());
+            int next = 0;
+            for (int i = first; i < tasks.size(); ++i) {
+                if (existing.contains(tasks[i].id)) {
+                    m_tasks.append(survivors[next++]);
+                } else {
+                    m_tasks.append(tasks[i]);
+                    ++inserted;
+                }
+            }
+        }
+        rebuildIndex();
+    }
+
+    // 4. Rows now line up one to one: notify only the roles that differ
+    int updated = 0;
+    for (int i = 0; i < m_tasks.size(); ++i) {
+        QVector<int> roles = changedRoles(m_tasks[i], tasks[i]);
+        if (roles.isEmpty()) {
+            continue;
+        }
+        m_tasks[i] = tasks[i];
+        notifyRowsChanged(i, i, roles);
+        ++updated;
+    }
+
+    // Rows already match; adopt the vector (with its source order) wholesale
     m_tasks = tasks;
-    endResetModel();
+    exposeRows(m_pageSize);
+    endStoreBatch();
+
+    if (removed || moved || inserted || updated) {
+        qDebug() << "setTasks:" << inserted << "inserted," << removed << "removed,"
+                 << moved << "moved," << updated << "updated";
+    }
+}
+
+QSet<QString> TaskModel::stableTaskIds(const QVector<Task>& tasks) const
+{
+    // Current rows of the surviving tasks, listed in their new order
+    QHash<QString, int> currentRows;
+    currentRows.reserve(m_tasks.size());
+    for (int i = 0; i < m_tasks.size(); ++i) {
+        currentRows.insert(m_tasks[i].id, i);
+    }
+
+    QVector<int> sequence;
+    QVector<QString> ids;
+    for (const Task& task : tasks) {
+        auto it = currentRows.constFind(task.id);
+        if (it != currentRows.constEnd()) {
+            sequence.append(it.value());
+            ids.append(task.id);
+        }
+    }
+
+    // Longest increasing subsequence (patience sorting, O(n log n))
+    QVector<int> tailIndex;               // Index into sequence ending each run length
+    QVector<int> predecessor(sequence.size(), -1);
+    for (int i = 0; i < sequence.size(); ++i) {
+        auto pos = std::lower_bound(tailIndex.begin(), tailIndex.end(), sequence[i],
+                                    [&sequence](int index, int value) {
+                                        return sequence[index] < value;
+                                    });
+        int length = static_cast<int>(pos - tailIndex.begin());
+        if (length > 0) {
+            predecessor[i] = tailIndex[length - 1];
+        }
+        if (pos == tailIndex.end()) {
+            tailIndex.append(i);
+        } else {
+            *pos = i;
+        }
+    }
+
+    QSet<QString> stable;
+    for (int i = tailIndex.isEmpty() ? -1 : tailIndex.last(); i >= 0; i = predecessor[i]) {
+        stable.insert(ids[i]);
+    }
+    return stable;
+}
+
+QVector<int> TaskModel::changedRoles(const Task& before, const Task& after)
+{
+    QVector<int> roles;
+    if (before.title != after.title) {
+        roles << TitleRole << Qt::DisplayRole;
+    }
+    if (before.dueDate != after.dueDate) {
+        roles << DueDateRole;
+    }
+    if (before.projectNameHandle != after.projectNameHandle) {
+        roles << ProjectNameRole;
+    }
+    if (before.priority != after.priority) {
+        roles << PriorityRole;
+    }
+    if (before.completed != after.completed) {
+        roles << CompletedRole;
+    }
+    if (before.labelsHandle != after.labelsHandle) {
+        roles << LabelsRole;
+    }
+    if (before.priority != after.priority) {
+        roles << PriorityLabelRole;
+    }
+    if (before.dueDate != after.dueDate || before.projectNameHandle != after.projectNameHandle) {
+        roles << MetadataRole;
+    }
+    if (before.dueDate != after.dueDate || before.priority != after.priority
+        || before.projectNameHandle != after.projectNameHandle) {
+        roles << SectionRole;
+    }
+    return roles;
 }
 
 const Task& TaskModel::taskAt(int row) const
@@ -72,31 +395,617 @@ int TaskModel::taskCount() const
 
 void TaskModel::setTaskCompleted(const QString& taskId, bool completed)
 {
-    // Find task by ID in m_tasks vector
-    for (int i = 0; i < m_tasks.size(); ++i) {
-        if (m_tasks[i].id == taskId) {
-            // Check if state actually changed
-            if (m_tasks[i].completed == completed) {
-                return;  // No change needed
-            }
+    int row = rowForId(taskId);
+    if (row < 0) {
+        // Task not found - this is OK (might have been deleted elsewhere)
+        qDebug() << "setTaskCompleted: Task" << taskId << "not found in model";
+        return;
+    }
 
-            // Update task state
-            m_tasks[i].completed = completed;
+    // Check if state actually changed
+    if (m_tasks[row].completed == completed) {
+        return;  // No change needed
+    }
 
-            // Notify QML that this specific row's CompletedRole changed
-            QModelIndex idx = index(i, 0);
-            emit dataChanged(idx, idx, {CompletedRole});
-            return;
-        }
+    // Update task state; a completed task leaves the smart view counts
+    m_store.beginBatch();
+    m_tasks[row].completed = completed;
+    taskChanged(m_tasks[row]);
+
+    // Notify QML that this specific row's CompletedRole changed
+    notifyRowsChanged(row, row, {CompletedRole});
+    endStoreBatch();
+}
+
+bool TaskModel::replaceId(const QString& oldId, const QString& newId)
+{
+    int row = rowForId(oldId);
+    if (row < 0 || newId.isEmpty()) {
+        qDebug() << "replaceId: Task" << oldId << "not found in model";
+        return false;
     }
 
-    // Task not found - this is OK (might have been deleted elsewhere)
-    qDebug() << "setTaskCompleted: Task" << taskId << "not found in model";
+    m_tasks[row].id = newId;
+    m_rowIndex.remove(oldId);
+    m_rowIndex.insert(newId, row - m_rowBase);
+    m_searchIndex.rename(oldId, newId);
+    m_store.rename(oldId, newId);
+
+    notifyRowsChanged(row, row, {IdRole});
+    return true;
 }
 
 void TaskModel::addTask(const Task& task)
 {
-    beginInsertRows(QModelIndex(), 0, 0);  // Insert at top
-    m_tasks.prepend(task);
+    // New tasks go to the top of the API ordering
+    Task added = task;
+    added.sourceOrder = --m_firstSourceOrder;
+    m_store.beginBatch();
+    insertSorted(added);
+    exposeRows(m_pageSize);
+    endStoreBatch();
+}
+
+void TaskModel::appendTasks(const QVector<Task>& tasks)
+{
+    if (tasks.isEmpty()) {
+        return;
+    }
+
+    QVector<Task> batch = tasks;
+    for (Task& task : batch) {
+        task.sourceOrder = m_nextSourceOrder++;
+    }
+    m_store.beginBatch();
+
+    // In API order, or into an empty list, the batch is one contiguous run
+    if (m_sortMode == ApiOrder || m_tasks.isEmpty()) {
+        if (m_sortMode != ApiOrder) {
+            std::stable_sort(batch.begin(), batch.end(), [this](const Task& a, const Task& b) {
+                return lessThan(a, b);
+            });
+        }
+        for (const Task& task : batch) {
+            taskChanged(task);
+        }
+        insertTaskRows(m_tasks.size(), batch);
+    } else {
+        for (const Task& task : batch) {
+            insertSorted(task);
+        }
+    }
+
+    exposeRows(m_pageSize);
+    endStoreBatch();
+}
+
+void TaskModel::applyDelta(const QVector<Task>& changed, const QStringList& removedIds)
+{
+    m_store.beginBatch();
+
+    // Removals first so row numbers for upserts stay valid
+    for (const QString& taskId : removedIds) {
+        int row = rowForId(taskId);
+        if (row < 0) {
+            continue;  // Never seen locally (e.g. completed elsewhere before we synced)
+        }
+
+        removeTaskRows(row, row);
+    }
+
+    for (const Task& task : changed) {
+        int row = rowForId(task.id);
+        if (row < 0) {
+            // New task - last in the API's ordering
+            Task added = task;
+            added.sourceOrder = m_nextSourceOrder++;
+            insertSorted(added);
+            continue;
+        }
+
+        updateRow(row, task);
+    }
+    exposeRows(m_pageSize);
+    endStoreBatch();
+
+    qDebug() << "applyDelta:" << changed.size() << "upserted," << removedIds.size() << "removed";
+}
+
+void TaskModel::applyProjectNames(const QMap<QString, QString>& projectNames)
+{
+    // Intern the (small) project map once so the task loop compares handles
+    QHash<StringTable::Handle, StringTable::Handle> nameHandles;
+    nameHandles.reserve(projectNames.size());
+    for (auto it = projectNames.cbegin(); it != projectNames.cend(); ++it) {
+        nameHandles.insert(StringTable::intern(it.key()), StringTable::intern(it.value()));
+    }
+
+    m_store.beginBatch();
+    bool renamed = false;
+    for (int i = 0; i < m_tasks.size(); ++i) {
+        Task& task = m_tasks[i];
+        StringTable::Handle name = nameHandles.value(task.projectIdHandle, 0);
+        if (task.projectNameHandle == name) {
+            continue;
+        }
+
+        task.projectNameHandle = name;
+        taskChanged(task);
+        notifyRowsChanged(i, i, {ProjectNameRole, SectionRole, MetadataRole});
+        renamed = true;
+    }
+
+    // A rename can reorder whole groups; cheaper to re-sort once
+    if (renamed && m_sortMode == ProjectOrder) {
+        resort();
+    }
+    endStoreBatch();
+}
+
+void TaskModel::insertTaskRows(int first, const QVector<Task>& tasks, bool updateIndex)
+{
+    // Rows inserted inside the exposed range grow it; rows past it stay
+    // hidden until fetchMore() reaches them
+    bool exposed = first < m_exposedRows || !m_exposeAllHolders.isEmpty();
+    if (exposed) {
+        beginInsertRows(QModelIndex(), first, first + tasks.size() - 1);
+    }
+
+    m_tasks.insert(first, tasks.size(), Task());
+    std::copy(tasks.cbegin(), tasks.cend(), m_tasks.begin() + first);
+    if (updateIndex) {
+        shiftIndex(first, first + tasks.size(), tasks.size());
+        indexRows(first, first + tasks.size() - 1);
+    }
+
+    if (exposed) {
+        m_exposedRows += tasks.size();
+        endInsertRows();
+    }
+}
+
+void TaskModel::removeTaskRows(int first, int last)
+{
+    int exposedLast = qMin(last, m_exposedRows - 1);
+    bool exposed = first <= exposedLast;
+    if (exposed) {
+        beginRemoveRows(QModelIndex(), first, exposedLast);
+    }
+
+    forgetRows(first, last);
+    m_tasks.remove(first, last - first + 1);
+    shiftIndex(first, first, -(last - first + 1));
+
+    if (exposed) {
+        m_exposedRows -= exposedLast - first + 1;
+        endRemoveRows();
+    }
+}
+
+void TaskModel::moveTaskRow(int row, int target)
+{
+    // target is in pre-move row numbers, as beginMoveRows expects. A row can
+    // move within, into or out of the exposed range, or entirely past it
+    bool fromExposed = row < m_exposedRows;
+    bool toExposed = fromExposed ? target <= m_exposedRows : target < m_exposedRows;
+    int destination = row < target ? target - 1 : target;
+
+    if (fromExposed && toExposed) {
+        beginMoveRows(QModelIndex(), row, row, QModelIndex(), target);
+    } else if (fromExposed) {
+        beginRemoveRows(QModelIndex(), row, row);
+    } else if (toExposed) {
+        beginInsertRows(QModelIndex(), target, target);
+    }
+
+    m_tasks.move(row, destination);
+    indexRows(qMin(row, destination), qMax(row, destination));
+
+    if (fromExposed && toExposed) {
+        endMoveRows();
+    } else if (fromExposed) {
+        --m_exposedRows;
+        endRemoveRows();
+    } else if (toExposed) {
+        ++m_exposedRows;
+        endInsertRows();
+    }
+}
+
+void TaskModel::notifyRowsChanged(int first, int last, const QVector<int>& roles)
+{
+    last = qMin(last, m_exposedRows - 1);
+    if (first <= last) {
+        emit dataChanged(index(first, 0), index(last, 0), roles);
+    }
+}
+
+void TaskModel::exposeRows(int count)
+{
+    if (!m_exposeAllHolders.isEmpty()) {
+        count = m_tasks.size();
+    }
+    count = qMin(count, m_tasks.size());
+    if (count <= m_exposedRows) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), m_exposedRows, count - 1);
+    m_exposedRows = count;
     endInsertRows();
 }
+
+void TaskModel::hideRowsFrom(int count)
+{
+    if (count >= m_exposedRows) {
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), count, m_exposedRows - 1);
+    m_exposedRows = count;
+    endRemoveRows();
+}
+
+int TaskModel::rowForId(const QString& taskId) const
+{
+    auto it = m_rowIndex.constFind(taskId);
+    return it != m_rowIndex.constEnd() ? it.value() + m_rowBase : -1;
+}
+
+void TaskModel::indexRows(int first, int last)
+{
+    for (int i = first; i <= last; ++i) {
+        m_rowIndex.insert(m_tasks[i].id, i - m_rowBase);
+    }
+}
+
+void TaskModel::shiftIndex(int head, int tail, int delta)
+{
+    // Either move the rows from tail on, or move the base and pull the head
+    // back; cost is the shorter side, so edits near either end are O(rows edited)
+    if (head < m_tasks.size() - tail) {
+        m_rowBase += delta;
+        for (int i = 0; i < head; ++i) {
+            m_rowIndex[m_tasks[i].id] -= delta;
+        }
+    } else {
+        for (int i = tail; i < m_tasks.size(); ++i) {
+            m_rowIndex[m_tasks[i].id] += delta;
+        }
+    }
+}
+
+void TaskModel::rebuildIndex()
+{
+    m_rowIndex.clear();
+    m_rowIndex.reserve(m_tasks.size());
+    m_rowBase = 0;
+    indexRows(0, m_tasks.size() - 1);
+}
+
+void TaskModel::forgetRows(int first, int last)
+{
+    for (int i = first; i <= last; ++i) {
+        m_rowIndex.remove(m_tasks[i].id);
+        m_searchIndex.remove(m_tasks[i].id);
+        m_store.remove(m_tasks[i].id);
+    }
+}
+
+bool TaskModel::isSearchMatch(int row) const
+{
+    return row >= 0 && row < m_tasks.size() && m_searchIndex.isMatch(m_tasks[row].id);
+}
+
+void TaskModel::setView(const QString& view)
+{
+    TaskStore::View storeView = TaskStore::AllView;
+    StringTable::Handle project = 0;
+    if (view.startsWith(PROJECT_VIEW_PREFIX)) {
+        storeView = TaskStore::ProjectView;
+        project = StringTable::intern(view.mid(PROJECT_VIEW_PREFIX.size()));
+    } else {
+        for (int v = TaskStore::AllView; v < TaskStore::ProjectView; ++v) {
+            if (view == VIEW_NAMES[v]) {
+                storeView = static_cast<TaskStore::View>(v);
+                break;
+            }
+        }
+    }
+
+    m_view = storeView == TaskStore::ProjectView ? view : VIEW_NAMES[storeView];
+    m_store.setActiveView(storeView, project);
+    emit viewMatchesChanged();
+}
+
+bool TaskModel::isViewMatch(int row) const
+{
+    return row >= 0 && row < m_tasks.size() && m_store.isMatch(m_tasks[row].id);
+}
+
+QVariantMap TaskModel::viewCounts() const
+{
+    QVariantMap counts;
+    for (int v = TaskStore::AllView; v < TaskStore::ProjectView; ++v) {
+        counts.insert(VIEW_NAMES[v], m_store.count(static_cast<TaskStore::View>(v)));
+    }
+    return counts;
+}
+
+QString TaskModel::sortOrder() const
+{
+    switch (m_sortMode) {
+        case PriorityOrder: return "priority";
+        case DueDateOrder: return "due";
+        case ProjectOrder: return "project";
+        default: return "api";
+    }
+}
+
+void TaskModel::setSortOrder(const QString& sortOrder)
+{
+    SortMode mode = ApiOrder;
+    if (sortOrder == "priority") {
+        mode = PriorityOrder;
+    } else if (sortOrder == "due") {
+        mode = DueDateOrder;
+    } else if (sortOrder == "project") {
+        mode = ProjectOrder;
+    }
+
+    if (mode == m_sortMode) {
+        return;
+    }
+
+    m_sortMode = mode;
+    resort();
+    emit sortOrderChanged();
+}
+
+// Undated tasks sort after dated ones
+static int compareDueDates(const QDate& a, const QDate& b)
+{
+    if (a.isValid() != b.isValid()) {
+        return a.isValid() ? -1 : 1;
+    }
+    if (a == b) {
+        return 0;
+    }
+    return a < b ? -1 : 1;
+}
+
+bool TaskModel::lessThan(const Task& a, const Task& b) const
+{
+    int cmp = 0;
+    switch (m_sortMode) {
+        case PriorityOrder:
+            // Todoist priority 4 is P1
+            cmp = b.priority - a.priority;
+            if (cmp == 0) {
+                cmp = compareDueDates(a.dueDate, b.dueDate);
+            }
+            break;
+        case DueDateOrder:
+            cmp = compareDueDates(a.dueDate, b.dueDate);
+            if (cmp == 0) {
+                cmp = b.priority - a.priority;
+            }
+            break;
+        case ProjectOrder:
+            if (a.projectNameHandle == b.projectNameHandle) {
+                cmp = 0;
+            } else if (a.projectNameHandle == 0 || b.projectNameHandle == 0) {
+                cmp = a.projectNameHandle == 0 ? 1 : -1;
+            } else {
+                cmp = QString::compare(a.projectName(), b.projectName(), Qt::CaseInsensitive);
+            }
+            // Projects whose names match (ignoring case) still keep their
+            // tasks together
+            if (cmp == 0 && a.projectIdHandle != b.projectIdHandle) {
+                cmp = QString::compare(a.projectId(), b.projectId());
+            }
+            break;
+        case ApiOrder:
+            break;
+    }
+
+    // The API position breaks ties, so the order is total and stable
+    return cmp != 0 ? cmp < 0 : a.sourceOrder < b.sourceOrder;
+}
+
+bool TaskModel::orderKeyChanged(const Task& before, const Task& after) const
+{
+    switch (m_sortMode) {
+        case PriorityOrder:
+        case DueDateOrder:
+            return before.priority != after.priority || before.dueDate != after.dueDate;
+        case ProjectOrder:
+            return before.projectNameHandle != after.projectNameHandle
+                   || before.projectIdHandle != after.projectIdHandle;
+        case ApiOrder:
+            break;
+    }
+    return false;
+}
+
+int TaskModel::insertionRow(const Task& task) const
+{
+    auto it = std::upper_bound(m_tasks.cbegin(), m_tasks.cend(), task, [this](const Task& a, const Task& b) {
+        return lessThan(a, b);
+    });
+    return static_cast<int>(it - m_tasks.cbegin());
+}
+
+void TaskModel::insertSorted(const Task& task)
+{
+    taskChanged(task);
+    insertTaskRows(insertionRow(task), {task});
+}
+
+void TaskModel::updateRow(int row, const Task& task)
+{
+    Task updated = task;
+    updated.sourceOrder = m_tasks[row].sourceOrder;
+
+    QVector<int> roles = changedRoles(m_tasks[row], updated);
+    bool reorder = orderKeyChanged(m_tasks[row], updated);
+    m_tasks[row] = updated;
+    taskChanged(updated);
+
+    if (!roles.isEmpty()) {
+        notifyRowsChanged(row, row, roles);
+    }
+
+    if (!reorder) {
+        return;
+    }
+
+    // Binary search the rest of the list, which is still sorted
+    bool fitsBefore = row == 0 || !lessThan(updated, m_tasks[row - 1]);
+    bool fitsAfter = row == m_tasks.size() - 1 || !lessThan(m_tasks[row + 1], updated);
+    if (fitsBefore && fitsAfter) {
+        return;
+    }
+
+    int target;
+    if (!fitsBefore) {
+        auto it = std::upper_bound(m_tasks.cbegin(), m_tasks.cbegin() + row, updated,
+                                   [this](const Task& a, const Task& b) { return lessThan(a, b); });
+        target = static_cast<int>(it - m_tasks.cbegin());
+    } else {
+        auto it = std::upper_bound(m_tasks.cbegin() + row + 1, m_tasks.cend(), updated,
+                                   [this](const Task& a, const Task& b) { return lessThan(a, b); });
+        target = static_cast<int>(it - m_tasks.cbegin());
+    }
+
+    moveTaskRow(row, target);
+}
+
+void TaskModel::resort()
+{
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+    // Persistent indexes (e.g. ListView's current item) follow their task
+    const QModelIndexList persistent = persistentIndexList();
+    QStringList persistentIds;
+    for (const QModelIndex& idx : persistent) {
+        persistentIds.append(m_tasks[idx.row()].id);
+    }
+
+    std::stable_sort(m_tasks.begin(), m_tasks.end(), [this](const Task& a, const Task& b) {
+        return lessThan(a, b);
+    });
+    rebuildIndex();
+
+    // Tasks sorted past the exposed rows get an invalid index
+    QModelIndexList updated;
+    for (const QString& id : persistentIds) {
+        updated.append(index(rowForId(id), 0));
+    }
+    changePersistentIndexList(persistent, updated);
+
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+QString TaskModel::sectionFor(const Task& task) const
+{
+    switch (m_sortMode) {
+        case PriorityOrder:
+            return task.priority > 0 ? priorityLabel(task.priority) : QStringLiteral("No priority");
+        case DueDateOrder:
+            if (!task.dueDate.isValid()) {
+                return QStringLiteral("No date");
+            }
+            if (task.dueDate < m_today) {
+                return QStringLiteral("Overdue");
+            }
+            return task.dueDate == m_today ? QStringLiteral("Today") : QStringLiteral("Upcoming");
+        case ProjectOrder:
+            return task.projectNameHandle == 0 ? QStringLiteral("No project") : task.projectName();
+        case ApiOrder:
+            break;
+    }
+    return QString();
+}
+
+QString TaskModel::dueDateText(const QDate& date) const
+{
+    if (!date.isValid()) {
+        return QString();
+    }
+
+    auto it = m_dueDateText.constFind(date.toJulianDay());
+    if (it != m_dueDateText.constEnd()) {
+        return it.value();
+    }
+
+    QString text = Task::formatDueDate(date);
+    m_dueDateText.insert(date.toJulianDay(), text);
+    return text;
+}
+
+QString TaskModel::metadataText(const Task& task) const
+{
+    // Invalid dates map to day 0, which no real due date uses
+    quint64 day = task.dueDate.isValid() ? quint64(task.dueDate.toJulianDay()) : 0;
+    quint64 key = (quint64(task.projectNameHandle) << 32) | (day & 0xffffffff);
+
+    auto it = m_metadataText.constFind(key);
+    if (it != m_metadataText.constEnd()) {
+        return it.value();
+    }
+
+    QStringList parts;
+    if (task.projectNameHandle != 0) {
+        parts << task.projectName();
+    }
+    if (task.dueDate.isValid()) {
+        parts << dueDateText(task.dueDate);
+    }
+
+    QString text = parts.join(" | ");
+    m_metadataText.insert(key, text);
+    return text;
+}
+
+void TaskModel::taskChanged(const Task& task)
+{
+    metadataText(task);  // Also caches the due date text
+    m_searchIndex.insert(task);
+    m_store.upsert(task);
+}
+
+void TaskModel::endStoreBatch()
+{
+    if (m_store.endBatch()) {
+        emit viewCountsChanged();
+    }
+}
+
+void TaskModel::scheduleMidnight()
+{
+    // A second past midnight so currentDate() has certainly moved on
+    qint64 msecs = QDateTime::currentDateTime().msecsTo(m_today.addDays(1).startOfDay()) + 1000;
+    m_midnightTimer.start(static_cast<int>(qBound<qint64>(1000, msecs, 24 * 60 * 60 * 1000)));
+}
+
+void TaskModel::rollOverDay()
+{
+    QDate today = QDate::currentDate();
+    if (today != m_today) {
+        m_today = today;
+
+        // Only the Overdue/Today/Upcoming sections are relative to today
+        if (m_sortMode == DueDateOrder) {
+            notifyRowsChanged(0, m_tasks.size() - 1, {SectionRole});
+        }
+
+        // So are the Today, Overdue and Upcoming views
+        m_store.beginBatch();
+        m_store.setToday(today);
+        endStoreBatch();
+        emit viewMatchesChanged();
+    }
+
+    scheduleMidnight();
+}
@@ -3,11 +3,47 @@
 
 #include <QAbstractListModel>
 #include <QVector>
+#include <QMap>
+#include <QStringList>
+#include <QSet>
+#include <QHash>
+#include <QDate>
+#include <QTimer>
+#include <QVariantMap>
 #include "task.h"
+#include "task_search_index.h"
+#include "task_store.h"
 
+/**
+ * @brief List model of active tasks, kept sorted by the selected ordering.
+ *
+ * Rows are always stored in display order. Single-task changes find their
+ * row with a binary search over the current ordering instead of re-sorting,
+ * and the "section" role gives the group header for the row (Overdue /
+ * Today / Upcoming, P1-P4 or project name) for ListView sections.
+ *
+ * Only the first rows are exposed to views: rowCount() covers one page
+ * after a load and fetchMore() adds a page at a time, so a 10,000-task
+ * account costs a view no more than a 50-task one until it scrolls. The
+ * full list stays in memory for sorting, sync and search.
+ *
+ * Display strings (due date, metadata line) are formatted when a task
+ * changes and cached by value, so data() during scrolling only does
+ * lookups. Sections relative to today are refreshed at midnight.
+ *
+ * A TaskStore indexes every task by due date, priority and project for the
+ * smart views (Today, Overdue, Upcoming, P1, one project). Each public
+ * update runs as one store batch, so view counts change once per refresh,
+ * delta or completion.
+ */
 class TaskModel : public QAbstractListModel
 {
     Q_OBJECT
+    // "api", "priority", "due" or "project"
+    Q_PROPERTY(QString sortOrder READ sortOrder WRITE setSortOrder NOTIFY sortOrderChanged)
+    Q_PROPERTY(int pageSize READ pageSize WRITE setPageSize NOTIFY pageSizeChanged)
+    // View name -> task count, for the built-in smart views
+    Q_PROPERTY(QVariantMap viewCounts READ viewCounts NOTIFY viewCountsChanged)
 
 public:
     enum TaskRoles {
@@ -16,7 +52,18 @@ public:
         DueDateRole,
         ProjectNameRole,
         PriorityRole,
-        CompletedRole
+        CompletedRole,
+        SectionRole,
+        LabelsRole,
+        PriorityLabelRole,  // "P1".."P4"
+        MetadataRole        // "Project | Mon, Jan 30", either part may be missing
+    };
+
+    enum SortMode {
+        ApiOrder,       // As returned by Todoist
+        PriorityOrder,  // P1 first, then by due date
+        DueDateOrder,   // Soonest first, undated last
+        ProjectOrder    // By project name (then ID), API order within a project
     };
 
     explicit TaskModel(QObject *parent = nullptr);
@@ -27,14 +74,117 @@ public:
     QHash<int, QByteArray> roleNames() const override;
 
     // Custom methods
+    // Diffed by Task::id - no model reset. Tasks arrive in API order with
+    // sourceOrder set; a uniquely owned vector is sorted in place and adopted
     void setTasks(const QVector<Task> &tasks);
+    void setTasks(QVector<Task> &&tasks);
     const Task& taskAt(int row) const;
     int taskCount() const;
+
+    // Every task in display order, including rows not exposed yet
+    const QVector<Task>& tasks() const { return m_tasks; }
     void setTaskCompleted(const QString& taskId, bool completed);
+    bool replaceId(const QString& oldId, const QString& newId);  // Temp ID -> server ID once synced
     void addTask(const Task& task);  // Add a single task to the top of the list
+    void appendTasks(const QVector<Task>& tasks);  // Add rows at the end (streamed loads)
+
+    // Incremental sync: upsert changed tasks and drop removed ones without a model reset
+    void applyDelta(const QVector<Task>& changed, const QStringList& removedIds);
+
+    // Re-resolve project names after projects were renamed/removed
+    void applyProjectNames(const QMap<QString, QString>& projectNames);
+
+    QString sortOrder() const;
+    void setSortOrder(const QString& sortOrder);
+
+    // Paging: rows exposed per fetchMore()
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    // A filter over the whole list holds every row exposed, including rows
+    // loaded later; paging resumes from the first page once no one holds it
+    void setExposeAll(const QObject* holder, bool exposeAll);
+    int pageSize() const;
+    void setPageSize(int pageSize);
+
+    // Search over titles and project names, kept in step with the rows
+    const TaskSearchIndex& searchIndex() const { return m_searchIndex; }
+    void setSearchQuery(const QString& query) { m_searchIndex.setQuery(query); }
+    bool isSearchMatch(int row) const;
+
+    // Smart views: "all", "today", "overdue", "upcoming", "p1" or "project:<id>"
+    const TaskStore& store() const { return m_store; }
+    QString view() const { return m_view; }
+    void setView(const QString& view);
+    bool isViewMatch(int row) const;
+    QVariantMap viewCounts() const;
+
+signals:
+    void sortOrderChanged();
+    void pageSizeChanged();
+    void viewCountsChanged();
+    void viewMatchesChanged();  // The active view's rows changed without a row update (view or day switched)
 
 private:
+    // id -> row lookups through m_rowIndex
+    int rowForId(const QString& taskId) const;
+    void indexRows(int first, int last);           // Record the current position of these rows
+    void shiftIndex(int head, int tail, int delta);  // Rows before head stayed, rows from tail moved by delta
+    void rebuildIndex();
+    void forgetRows(int first, int last);  // Call before removing the rows
+    void adoptTasks(const QVector<Task>& tasks);  // setTasks() diff, tasks already in display order
+    QSet<QString> stableTaskIds(const QVector<Task>& tasks) const;  // Rows setTasks() need not move
+    static QVector<int> changedRoles(const Task& before, const Task& after);
+
+    // Row changes, with signals limited to the exposed rows
+    void insertTaskRows(int first, const QVector<Task>& tasks, bool updateIndex = true);  // Else the caller rebuilds it
+    void removeTaskRows(int first, int last);
+    void moveTaskRow(int row, int target);
+    void notifyRowsChanged(int first, int last, const QVector<int>& roles);
+    void exposeRows(int count);  // Everything while an expose-all hold is active
+    void hideRowsFrom(int count);
+
+    // Ordering
+    bool lessThan(const Task& a, const Task& b) const;
+    bool orderKeyChanged(const Task& before, const Task& after) const;
+    int insertionRow(const Task& task) const;
+    void insertSorted(const Task& task);
+    void updateRow(int row, const Task& task);  // Replace, moving the row if its position changed
+    void resort();
+    QString sectionFor(const Task& task) const;
+
+    // Display string cache
+    QString dueDateText(const QDate& date) const;
+    QString metadataText(const Task& task) const;
+    void taskChanged(const Task& task);  // Refresh caches, the search index and the store
+    void endStoreBatch();  // End a store batch, announcing new view counts
+    void scheduleMidnight();
+    void rollOverDay();
+
     QVector<Task> m_tasks;
+    SortMode m_sortMode;
+    int m_nextSourceOrder;  // For tasks appended after the last full load
+    int m_firstSourceOrder; // Decremented for tasks added at the top
+    int m_exposedRows;      // rowCount(); the rest wait for fetchMore()
+    int m_pageSize;
+    QSet<const QObject*> m_exposeAllHolders;
+
+    // Stored positions are relative to m_rowBase (row = stored + base), so
+    // rows shifted by an insert or removal are fixed up on the shorter side:
+    // an edit near the top moves the base instead of touching every row below
+    QHash<QString, int> m_rowIndex;
+    int m_rowBase;
+
+    // Formatted strings keyed by their inputs; few distinct values even for
+    // large lists, so many rows share one cached string
+    mutable QHash<qint64, QString> m_dueDateText;    // Julian day -> "Mon, Jan 30"
+    mutable QHash<quint64, QString> m_metadataText;  // (project, due date) -> metadata line
+    QDate m_today;
+    QTimer m_midnightTimer;
+
+    TaskSearchIndex m_searchIndex;
+    TaskStore m_store;
+    QString m_view;
 };
 
 #endif // TASKMODEL_H
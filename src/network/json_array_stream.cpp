@@ -0,0 +1,120 @@
+#include "json_array_stream.h"
+#include <QJsonDocument>
+#include <QJsonParseError>
+
+JsonArrayStream::JsonArrayStream()
+    : m_depth(0)
+    , m_inString(false)
+    , m_escape(false)
+    , m_finished(false)
+{
+}
+
+void JsonArrayStream::reset()
+{
+    m_element.clear();
+    m_depth = 0;
+    m_inString = false;
+    m_escape = false;
+    m_finished = false;
+    m_error.clear();
+}
+
+void JsonArrayStream::fail(const QString& error)
+{
+    m_error = error;
+    m_element.clear();
+}
+
+QVector<QJsonObject> JsonArrayStream::feed(const QByteArray& chunk)
+{
+    QVector<QJsonObject> objects;
+    if (m_finished || hasError()) {
+        return objects;
+    }
+
+    const char* data = chunk.constData();
+    const int size = chunk.size();
+
+    // Start of the element within this chunk (0 if it began in an earlier chunk)
+    int elementStart = m_depth >= 2 ? 0 : -1;
+
+    for (int i = 0; i < size; ++i) {
+        const char c = data[i];
+
+        // Brackets inside string values must not affect nesting
+        if (m_inString) {
+            if (m_escape) {
+                m_escape = false;
+            } else if (c == '\\') {
+                m_escape = true;
+            } else if (c == '"') {
+                m_inString = false;
+            }
+            continue;
+        }
+
+        // Inside an element: only track nesting until its closing brace
+        if (m_depth >= 2) {
+            if (c == '"') {
+                m_inString = true;
+            } else if (c == '{' || c == '[') {
+                ++m_depth;
+            } else if (c == '}' || c == ']') {
+                if (--m_depth > 1) {
+                    continue;
+                }
+
+                // Element complete - parse just this object
+                m_element.append(data + elementStart, i - elementStart + 1);
+                elementStart = -1;
+
+                QJsonParseError parseError;
+                QJsonDocument doc = QJsonDocument::fromJson(m_element, &parseError);
+                m_element.clear();
+
+                if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+                    fail(QString("Invalid array element: %1").arg(parseError.errorString()));
+                    return objects;
+                }
+                objects.append(doc.object());
+            }
+            continue;
+        }
+
+        if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+            continue;
+        }
+
+        if (m_depth == 0) {
+            if (c != '[') {
+                fail("Expected a JSON array");
+                return objects;
+            }
+            m_depth = 1;
+            continue;
+        }
+
+        // Between elements of the array
+        if (c == ',') {
+            continue;
+        } else if (c == ']') {
+            m_depth = 0;
+            m_finished = true;
+            return objects;
+        } else if (c == '{') {
+            m_depth = 2;
+            elementStart = i;
+        } else {
+            fail(QString("Unexpected '%1' between array elements").arg(QLatin1Char(c)));
+            return objects;
+        }
+    }
+
+    // Keep the partial element for the next chunk
+    if (elementStart >= 0) {
+        m_element.append(data + elementStart, size - elementStart);
+    }
+
+    return objects;
+}
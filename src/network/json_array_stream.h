@@ -0,0 +1,53 @@
+#ifndef JSON_ARRAY_STREAM_H
+#define JSON_ARRAY_STREAM_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Incremental parser for a top-level JSON array of objects.
+ *
+ * Feed the response body in arbitrary chunks as it arrives; each call
+ * returns the array elements completed by that chunk. Only the element
+ * currently being received is buffered, so the whole body and its full
+ * QJsonDocument never exist in memory at once.
+ *
+ * Usage:
+ *   JsonArrayStream stream;
+ *   for (const QJsonObject& obj : stream.feed(reply->readAll())) { ... }
+ *   if (stream.hasError()) { ... }
+ */
+class JsonArrayStream
+{
+public:
+    JsonArrayStream();
+
+    /**
+     * @brief Consume the next chunk of the body
+     * @param chunk Raw bytes, split anywhere (even inside strings)
+     * @return Objects whose closing brace was in this chunk, in order
+     */
+    QVector<QJsonObject> feed(const QByteArray& chunk);
+
+    // True once the closing ']' of the array has been seen
+    bool isFinished() const { return m_finished; }
+
+    bool hasError() const { return !m_error.isEmpty(); }
+    QString errorString() const { return m_error; }
+
+    void reset();
+
+private:
+    void fail(const QString& error);
+
+    QByteArray m_element;  // Bytes of the element in progress
+    int m_depth;           // 0 = before '[', 1 = inside the array, 2+ = inside an element
+    bool m_inString;
+    bool m_escape;
+    bool m_finished;
+    QString m_error;
+};
+
+#endif // JSON_ARRAY_STREAM_H
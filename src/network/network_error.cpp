@@ -0,0 +1,116 @@
+#include "network_error.h"
+#include <QNetworkReply>
+#include <QDateTime>
+#include <QLocale>
+#include <QTimeZone>
+
+NetworkError NetworkError::fromReply(QNetworkReply* reply)
+{
+    NetworkError error;
+    error.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (reply->hasRawHeader("Retry-After")) {
+        error.retryAfterMs = parseRetryAfter(reply->rawHeader("Retry-After"));
+    }
+
+    // The server answered: the status says what went wrong
+    switch (error.httpStatus) {
+        case 401:
+            error.category = Auth;
+            error.message = "Invalid API token. Please check your token in settings.";
+            return error;
+        case 403:
+            error.category = Auth;
+            error.message = "Access forbidden. Your token may not have the required permissions.";
+            return error;
+        case 404:
+            error.category = ClientError;
+            error.message = "API endpoint not found. The Todoist API may have changed.";
+            return error;
+        case 429:
+            error.category = RateLimited;
+            error.message = "Too many requests. Please wait a moment and try again.";
+            return error;
+        default:
+            break;
+    }
+    if (error.httpStatus >= 500) {
+        error.category = ServerError;
+        error.message = "Todoist server error. Please try again later.";
+        return error;
+    }
+    if (error.httpStatus >= 400) {
+        error.category = ClientError;
+        error.message = QString("Request rejected with status %1").arg(error.httpStatus);
+        return error;
+    }
+
+    // No usable answer: classify the transport failure
+    switch (reply->error()) {
+        case QNetworkReply::NoError:
+            return error;
+        case QNetworkReply::TimeoutError:
+        case QNetworkReply::OperationCanceledError:  // Transfer timeout aborts the reply
+        case QNetworkReply::ProxyTimeoutError:
+            error.category = Timeout;
+            break;
+        case QNetworkReply::ConnectionRefusedError:
+        case QNetworkReply::RemoteHostClosedError:
+        case QNetworkReply::HostNotFoundError:
+        case QNetworkReply::TemporaryNetworkFailureError:
+        case QNetworkReply::NetworkSessionFailedError:
+        case QNetworkReply::UnknownNetworkError:
+        case QNetworkReply::SslHandshakeFailedError:  // Typically a captive portal
+        case QNetworkReply::ProxyConnectionRefusedError:
+        case QNetworkReply::ProxyConnectionClosedError:
+        case QNetworkReply::ProxyNotFoundError:
+            error.category = Offline;
+            break;
+        default:
+            error.category = ServerError;  // Protocol-level failure mid-response
+            break;
+    }
+    error.message = QString("Network error: %1").arg(reply->errorString());
+    return error;
+}
+
+NetworkError NetworkError::badResponse(const QString& message)
+{
+    NetworkError error;
+    error.category = BadResponse;
+    error.message = message;
+    return error;
+}
+
+const char* NetworkError::categoryName(Category category)
+{
+    switch (category) {
+        case NoError: return "none";
+        case Offline: return "offline";
+        case Timeout: return "timeout";
+        case Auth: return "auth";
+        case RateLimited: return "rate-limited";
+        case ServerError: return "server";
+        case ClientError: return "client";
+        case BadResponse: return "bad-response";
+    }
+    return "unknown";
+}
+
+qint64 NetworkError::parseRetryAfter(const QByteArray& value)
+{
+    QByteArray trimmed = value.trimmed();
+
+    bool ok = false;
+    qint64 seconds = trimmed.toLongLong(&ok);
+    if (ok) {
+        return seconds >= 0 ? seconds * 1000 : -1;
+    }
+
+    // IMF-fixdate, e.g. "Wed, 21 Oct 2015 07:28:00 GMT"
+    QDateTime when = QLocale::c().toDateTime(QString::fromLatin1(trimmed), "ddd, dd MMM yyyy HH:mm:ss 'GMT'");
+    if (!when.isValid()) {
+        return -1;
+    }
+    when.setTimeZone(QTimeZone::utc());
+    return qMax<qint64>(0, QDateTime::currentDateTimeUtc().msecsTo(when));
+}
@@ -0,0 +1,53 @@
+#ifndef NETWORK_ERROR_H
+#define NETWORK_ERROR_H
+
+#include <QMetaType>
+#include <QString>
+
+class QNetworkReply;
+
+/**
+ * @brief A failed API request, classified from the reply.
+ *
+ * The category comes from the HTTP status when the server answered and
+ * from QNetworkReply::NetworkError otherwise, so callers can decide how to
+ * react (retry, wait for connectivity, give up) without inspecting the
+ * user-facing message.
+ */
+struct NetworkError {
+    enum Category {
+        NoError,
+        Offline,      // No route to the server: DNS, refused, reset, no network
+        Timeout,      // Sent, but no answer within the transfer timeout
+        Auth,         // 401/403 - retrying will not help until the token changes
+        RateLimited,  // 429
+        ServerError,  // 5xx
+        ClientError,  // Other 4xx
+        BadResponse   // 2xx the client could not parse
+    };
+
+    Category category;
+    int httpStatus;   // 0 if the server never answered
+    QString message;  // User-friendly text for the UI
+    qint64 retryAfterMs;  // From a Retry-After header, or -1
+
+    NetworkError() : category(NoError), httpStatus(0), retryAfterMs(-1) {}
+
+    static NetworkError fromReply(QNetworkReply* reply);
+    static NetworkError badResponse(const QString& message);
+
+    // The server could not be reached at all
+    bool isConnectivity() const { return category == Offline || category == Timeout; }
+
+    // Worth retrying later without any change on our side
+    bool isTransient() const { return isConnectivity() || category == RateLimited || category == ServerError; }
+
+    static const char* categoryName(Category category);
+
+    // Retry-After value (delay-seconds or HTTP-date) in milliseconds, -1 if unusable
+    static qint64 parseRetryAfter(const QByteArray& value);
+};
+
+Q_DECLARE_METATYPE(NetworkError)
+
+#endif // NETWORK_ERROR_H
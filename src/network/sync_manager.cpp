@@ -2,33 +2,85 @@
 #include "todoist_client.h"
 #include <QNetworkInformation>
 #include <QUuid>
+#include <QRandomGenerator>
+#include <QPair>
+#include <QSet>
 #include <QDebug>
 
+// Todoist accepts at most 100 commands per Sync API request
+static const int MAX_BATCH_SIZE = 100;
+
+// Concurrent requests allowed unless overridden with setMaxInFlight()
+static const int DEFAULT_MAX_IN_FLIGHT = 4;
+
+// Attempts before a failing operation is abandoned; with backoff this
+// spans roughly half an hour
+static const int MAX_RETRIES = 10;
+
+// Retry delay: doubles from the base per attempt up to the cap, with half
+// of it randomized so failed operations from many batches spread out
+static const qint64 RETRY_BASE_DELAY_MS = 2000;
+static const qint64 RETRY_MAX_DELAY_MS = 5 * 60 * 1000;
+
+// Operations queued by the user this recently go out ahead of the backlog
+static const qint64 INTERACTIVE_WINDOW_MS = 10000;
+
+// Extra request slot beyond the window, usable only by the interactive lane
+static const int INTERACTIVE_RESERVED_SLOTS = 1;
+
+// Failed attempts after which an operation is parked: sent alone, one at a time
+static const int PARK_AFTER_RETRIES = 3;
+
+// Consecutive server errors that open the circuit breaker (connectivity
+// errors open it straight away)
+static const int BREAKER_FAILURE_THRESHOLD = 3;
+
+// Connectivity probe delay while the breaker is open, doubling up to the cap
+static const int PROBE_INITIAL_INTERVAL_MS = 5000;
+static const int PROBE_MAX_INTERVAL_MS = 60000;
+
 SyncManager::SyncManager(TodoistClient* client, QObject* parent)
     : QObject(parent)
     , m_client(client)
     , m_isOnline(true)  // Optimistic - assume online until proven otherwise
     , m_isSyncing(false)
     , m_useNetworkInfo(false)
+    , m_authRejected(false)
+    , m_maxInFlight(DEFAULT_MAX_IN_FLIGHT)
+    , m_batchLimit(MAX_BATCH_SIZE)
+    , m_breakerState(BreakerClosed)
+    , m_consecutiveFailures(0)
+    , m_probeIntervalMs(PROBE_INITIAL_INTERVAL_MS)
 {
     // Connect TodoistClient signals
-    connect(m_client, &TodoistClient::taskClosed, this, &SyncManager::onTaskClosed);
-    connect(m_client, &TodoistClient::closeTaskFailed, this, &SyncManager::onCloseTaskFailed);
-    connect(m_client, &TodoistClient::taskCreated, this, &SyncManager::onTaskCreated);
-    connect(m_client, &TodoistClient::createTaskFailed, this, &SyncManager::onCreateTaskFailed);
+    connect(m_client, &TodoistClient::commandsCompleted, this, &SyncManager::onCommandsCompleted);
+    connect(m_client, &TodoistClient::commandsFailed, this, &SyncManager::onCommandsFailed);
+    connect(m_client, &TodoistClient::connectivityProbed, this, &SyncManager::onConnectivityProbed);
+
+    // Probes run only while the breaker is open
+    m_probeTimer.setSingleShot(true);
+    connect(&m_probeTimer, &QTimer::timeout, m_client, &TodoistClient::probeConnectivity);
 
     // Initialize network monitoring
     initializeNetworkMonitoring();
 
-    // Set up retry timer (2 second delay for connectivity restoration)
+    // Wakes the window when the earliest backed-off operation or rate limit slot is due
     m_retryTimer.setSingleShot(true);
-    m_retryTimer.setInterval(2000);
-    connect(&m_retryTimer, &QTimer::timeout, this, &SyncManager::processNextOperation);
+    m_clock.start();
+    connect(&m_retryTimer, &QTimer::timeout, this, &SyncManager::fillWindow);
 
     // Connect queue signals
     connect(&m_queue, &SyncQueue::countChanged, this, &SyncManager::pendingCountChanged);
 
-    // Load persisted queue
+    // A backoff deadline only means something while its operation is queued
+    // as it was; a coalesced operation starts over
+    connect(&m_queue, &SyncQueue::operationsRemoved, this, &SyncManager::forgetRetries);
+    connect(&m_queue, &SyncQueue::operationCoalesced, this, [this](const QString& uuid) {
+        m_retryAt.remove(uuid);
+    });
+    connect(&m_queue, &SyncQueue::operationsPersisted, this, &SyncManager::onOperationsPersisted);
+
+    // Load persisted queue (snapshot + replayed log)
     m_queue.loadFromFile();
 
     qDebug() << "SyncManager initialized with" << m_queue.count() << "pending operations";
@@ -51,8 +103,9 @@ void SyncManager::initializeNetworkMonitoring()
             qDebug() << "SyncManager: QNetworkInformation monitoring enabled";
 
             // Get initial state
-            bool online = (netInfo->reachability() == QNetworkInformation::Reachability::Online);
-            setOnline(online);
+            if (netInfo->reachability() != QNetworkInformation::Reachability::Online) {
+                openBreaker("no network at startup");
+            }
         } else {
             m_useNetworkInfo = false;
             qWarning() << "SyncManager: QNetworkInformation instance not available";
@@ -65,12 +118,6 @@ void SyncManager::initializeNetworkMonitoring()
 
 void SyncManager::queueTaskCompletion(const QString& taskId)
 {
-    // Check for duplicate operations
-    if (m_queue.hasOperationForTask(taskId, "close_task")) {
-        qDebug() << "Task" << taskId << "already in queue, skipping duplicate";
-        return;
-    }
-
     // Create operation
     SyncOperation op;
     op.uuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
@@ -79,12 +126,13 @@ void SyncManager::queueTaskCompletion(const QString& taskId)
     op.queuedAt = QDateTime::currentDateTime();
     op.retryCount = 0;
 
-    // Add to queue
-    m_queue.enqueue(op);
+    // Add to queue (persisted by the queue's log); duplicate closes are
+    // dropped and closes of unsent creates are folded into the create
+    if (m_queue.enqueue(op, m_inFlightUuids) != SyncQueue::Enqueued) {
+        return;
+    }
     qDebug() << "Queued task completion:" << taskId << "uuid:" << op.uuid;
-
-    // Save to disk
-    m_queue.saveToFile();
+    m_interactive.append(qMakePair(op.uuid, m_clock.elapsed()));
 
     // Attempt immediate sync
     processQueue();
@@ -101,17 +149,32 @@ void SyncManager::queueTaskCreation(const QString& content, const QString& tempI
     op.queuedAt = QDateTime::currentDateTime();
     op.retryCount = 0;
 
-    // Add to queue
+    // Add to queue (persisted by the queue's log); reported once it is on disk
     m_queue.enqueue(op);
+    m_createsAwaitingDisk.insert(op.uuid, tempId);
     qDebug() << "Queued task creation:" << content << "tempId:" << tempId << "uuid:" << op.uuid;
-
-    // Save to disk
-    m_queue.saveToFile();
+    m_interactive.append(qMakePair(op.uuid, m_clock.elapsed()));
 
     // Attempt immediate sync
     processQueue();
 }
 
+void SyncManager::setMaxInFlight(int maxRequests)
+{
+    m_maxInFlight = qMax(1, maxRequests);
+    qDebug() << "SyncManager: up to" << m_maxInFlight << "requests in flight";
+}
+
+void SyncManager::onOperationsPersisted(const QStringList& uuids)
+{
+    for (const QString& uuid : uuids) {
+        QString tempId = m_createsAwaitingDisk.take(uuid);
+        if (!tempId.isEmpty()) {
+            emit taskCreateQueued(tempId);
+        }
+    }
+}
+
 void SyncManager::processQueue()
 {
     if (m_queue.isEmpty()) {
@@ -119,191 +182,493 @@ void SyncManager::processQueue()
         return;
     }
 
-    if (m_isSyncing) {
-        qDebug() << "Already syncing, will process queue after current operation completes";
-        return;
-    }
+    fillWindow();
+}
 
-    processNextOperation();
+QString SyncManager::orderingKey(const SyncOperation& op)
+{
+    // A create and a later close of the same optimistic task share the temp ID
+    return op.type == "create_task" ? op.tempId : op.taskId;
 }
 
-void SyncManager::processNextOperation()
+void SyncManager::fillWindow()
 {
+    if (m_breakerState == BreakerOpen || m_authRejected) {
+        return;  // Doomed until a probe gets through, or the token changes
+    }
+
     if (m_queue.isEmpty()) {
-        setIsSyncing(false);
-        qDebug() << "Queue empty, sync complete";
+        m_interactive.clear();
+        m_batchLimit = MAX_BATCH_SIZE;  // A drained queue starts over at full size
+        if (m_inFlightRequests.isEmpty() && m_isSyncing) {
+            qDebug() << "Queue empty, sync complete in" << m_drainTimer.elapsed() << "ms";
+            setIsSyncing(false);
+        }
         return;
     }
 
-    setIsSyncing(true);
+    // Fresh user actions first, so they never wait behind the backlog
+    sendInteractive();
+    sendBackground();
+}
 
-    // Peek at next operation (don't remove until confirmed)
-    SyncOperation op = m_queue.peek();
-    m_currentSyncTaskId = op.taskId;
+void SyncManager::sendInteractive()
+{
+    qint64 now = m_clock.elapsed();
+    QVector<SyncOperation> batch;
+    QSet<QString> batchKeys;
+
+    for (auto it = m_interactive.begin(); it != m_interactive.end();) {
+        // Stale, already sent or gone: anything left belongs to the background lane
+        if (now - it->second > INTERACTIVE_WINDOW_MS || !m_queue.contains(it->first)
+            || m_inFlightUuids.contains(it->first)) {
+            it = m_interactive.erase(it);
+            continue;
+        }
 
-    qDebug() << "Processing operation:" << op.type << "taskId:" << op.taskId << "attempt:" << (op.retryCount + 1);
+        // Looked up directly, however long the queue in front of it is; it
+        // must still not overtake an earlier operation on the same task,
+        // whether that one is queued, backing off or in flight
+        SyncOperation op = m_queue.operation(it->first);
+        QString key = orderingKey(op);
+        bool blocked = m_inFlightKeys.contains(key) || batchKeys.contains(key)
+                       || m_retryAt.value(op.uuid, 0) > now
+                       || m_queue.hasEarlierOperationForTask(op.uuid, key);
+        if (!blocked && batch.size() < m_batchLimit) {
+            batch.append(op);
+            batchKeys.insert(key);
+        }
+        ++it;
+    }
 
-    // Process based on operation type
-    if (op.type == "close_task") {
-        m_client->closeTask(op.taskId);
-    } else if (op.type == "create_task") {
-        m_currentSyncContent = op.content;
-        m_currentSyncTaskId = op.tempId;  // Store tempId for matching responses
-        m_client->createTask(op.content);
-    } else {
-        qWarning() << "Unknown operation type:" << op.type;
-        // Remove invalid operation
-        m_queue.dequeue();
-        m_queue.saveToFile();
-        processNextOperation();
+    if (batch.isEmpty()) {
+        return;
+    }
+
+    // The reserved slot is not used for a half-open breaker's trial batch
+    int window = m_breakerState == BreakerHalfOpen ? 1 : m_maxInFlight + INTERACTIVE_RESERVED_SLOTS;
+    if (m_inFlightRequests.size() >= window) {
+        return;  // A completion will call back in
+    }
+
+    if (sendBatch(batch, InteractiveLane)) {
+        // First attempt made; a failure retries through the background lane
+        for (auto it = m_interactive.begin(); it != m_interactive.end();) {
+            it = m_inFlightUuids.contains(it->first) ? m_interactive.erase(it) : it + 1;
+        }
     }
 }
 
-void SyncManager::onTaskClosed(const QString& taskId)
+void SyncManager::sendBackground()
 {
-    if (taskId != m_currentSyncTaskId) {
-        qWarning() << "Received taskClosed for unexpected task:" << taskId << "expected:" << m_currentSyncTaskId;
+    // Half-open: one trial batch decides whether the breaker closes
+    int window = m_breakerState == BreakerHalfOpen ? 1 : m_maxInFlight;
+    int freeSlots = window - m_inFlightRequests.size();
+    if (freeSlots <= 0) {
+        return;  // Window full - completions will refill it
+    }
+
+    // Look as far ahead as the free slots could carry, plus whatever is
+    // skipped on the way (in flight or backing off)
+    QVector<SyncOperation> candidates = m_queue.peekBatch(
+        m_inFlightUuids.size() + m_retryAt.size() + freeSlots * m_batchLimit);
+
+    // Spread the backlog over the free slots so batches travel in parallel
+    int pending = candidates.size() - m_inFlightUuids.size();
+    int batchSize = qBound(1, (pending + freeSlots - 1) / freeSlots, m_batchLimit);
+
+    // Keys busy in another request (or skipped earlier in this scan) must wait,
+    // otherwise a close could overtake the create of the same task
+    QSet<QString> blockedKeys = m_inFlightKeys;
+    QHash<QString, int> batchForKey;
+    QVector<QVector<SyncOperation>> batches;
+    QVector<SyncOperation> parked;  // At most one, sent in a request of its own
+    QStringList invalid;
+    qint64 now = m_clock.elapsed();
+    qint64 nextDue = -1;  // Earliest backoff deadline still ahead
+
+    for (const SyncOperation& op : candidates) {
+        if (m_inFlightUuids.contains(op.uuid)) {
+            continue;
+        }
+
+        if (op.type != "close_task" && op.type != "create_task") {
+            qWarning() << "Unknown operation type:" << op.type;
+            invalid.append(op.uuid);
+            continue;
+        }
+
+        QString key = orderingKey(op);
+        if (blockedKeys.contains(key)) {
+            continue;
+        }
+
+        // Failed operations wait out their backoff (and hold back their task)
+        qint64 due = m_retryAt.value(op.uuid, 0);
+        if (due > now) {
+            nextDue = nextDue < 0 ? due : qMin(nextDue, due);
+            blockedKeys.insert(key);
+            continue;
+        }
+
+        // Repeat offenders go alone so they can't fail a whole batch, and
+        // only one at a time; they hold back nothing but their own task
+        if (op.retryCount >= PARK_AFTER_RETRIES) {
+            blockedKeys.insert(key);
+            if (parked.isEmpty() && m_parkedRequests.isEmpty()) {
+                parked.append(op);
+            }
+            continue;
+        }
+
+        // Keep every operation on one task in the same request, in queue order
+        int target = batchForKey.value(key, -1);
+        if (target < 0) {
+            if (batches.isEmpty() || batches.last().size() >= batchSize) {
+                if (batches.size() >= freeSlots) {
+                    blockedKeys.insert(key);
+                    continue;
+                }
+                batches.append(QVector<SyncOperation>());
+            }
+            target = batches.size() - 1;
+            batchForKey.insert(key, target);
+        } else if (batches[target].size() >= m_batchLimit) {
+            blockedKeys.insert(key);
+            continue;
+        }
+
+        batches[target].append(op);
+    }
+
+    if (!invalid.isEmpty()) {
+        m_queue.removeOperations(invalid);
+    }
+    if (nextDue >= 0) {
+        scheduleWake(nextDue - now);
+    }
+
+    if (batches.isEmpty() && parked.isEmpty()) {
+        if (m_inFlightRequests.isEmpty() && m_queue.isEmpty()) {
+            setIsSyncing(false);
+        }
         return;
     }
 
-    qDebug() << "Task closed successfully:" << taskId;
+    for (const QVector<SyncOperation>& batch : batches) {
+        if (!sendBatch(batch, BackgroundLane)) {
+            return;  // Rate limited; unsent batches are rebuilt when a slot frees up
+        }
+    }
+
+    if (!parked.isEmpty() && m_inFlightRequests.size() < window) {
+        sendBatch(parked, ParkedLane);
+    }
+}
 
-    // Remove from queue (operation confirmed successful)
-    m_queue.dequeue();
-    m_queue.saveToFile();
+bool SyncManager::sendBatch(const QVector<SyncOperation>& batch, Lane lane)
+{
+    // Stay under the API rate limit
+    qint64 waitMs = 0;
+    if (!m_client->tryAcquireRequest(&waitMs, lane == InteractiveLane)) {
+        qDebug() << "Rate limit reached, holding" << laneName(lane) << "batch of" << batch.size()
+                 << "operations for" << waitMs << "ms";
+        scheduleWake(waitMs);
+        return false;
+    }
 
-    // Confirmed online
-    setOnline(true);
+    if (m_inFlightRequests.isEmpty()) {
+        m_drainTimer.start();
+    }
+    setIsSyncing(true);
 
-    // Notify success
-    emit syncSucceeded(taskId);
+    for (const SyncOperation& op : batch) {
+        m_inFlightUuids.insert(op.uuid);
+        m_inFlightKeys.insert(orderingKey(op));
+    }
 
-    // Process next operation
-    processNextOperation();
+    QString requestId = m_client->submitCommands(batch);
+    m_inFlightRequests.insert(requestId, batch);
+    if (lane == ParkedLane) {
+        m_parkedRequests.insert(requestId);
+    }
+    qDebug() << "Sent" << laneName(lane) << "batch" << requestId << "with" << batch.size() << "operations,"
+             << m_inFlightRequests.size() << "requests in flight";
+    return true;
 }
 
-void SyncManager::onCloseTaskFailed(const QString& taskId, const QString& error)
+const char* SyncManager::laneName(Lane lane)
 {
-    if (taskId != m_currentSyncTaskId) {
-        qWarning() << "Received closeTaskFailed for unexpected task:" << taskId << "expected:" << m_currentSyncTaskId;
+    switch (lane) {
+        case InteractiveLane: return "interactive";
+        case ParkedLane: return "parked";
+        default: return "background";
+    }
+}
+
+QVector<SyncOperation> SyncManager::releaseRequest(const QString& requestId)
+{
+    QVector<SyncOperation> batch = m_inFlightRequests.take(requestId);
+    m_parkedRequests.remove(requestId);
+    for (const SyncOperation& op : batch) {
+        m_inFlightUuids.remove(op.uuid);
+        m_inFlightKeys.remove(orderingKey(op));
+    }
+    return batch;
+}
+
+void SyncManager::onCommandsCompleted(const QString& requestId, const QVector<CommandResult>& results)
+{
+    if (!m_inFlightRequests.contains(requestId)) {
+        qWarning() << "Received command results for unknown request:" << requestId;
         return;
     }
 
-    qWarning() << "Task close failed:" << taskId << "error:" << error;
+    QHash<QString, SyncOperation> sent;
+    for (const SyncOperation& op : releaseRequest(requestId)) {
+        sent.insert(op.uuid, op);
+    }
 
-    setIsSyncing(false);
+    QStringList finished;
+    QVector<QPair<SyncOperation, CommandResult>> outcomes;
 
-    // Emit failure signal
-    emit syncFailed(taskId, error);
+    for (const CommandResult& result : results) {
+        if (!sent.contains(result.uuid)) {
+            qWarning() << "Received command result for unexpected operation:" << result.uuid;
+            continue;
+        }
 
-    // Detect offline based on error message
-    QString lowerError = error.toLower();
-    if (lowerError.contains("timeout") || lowerError.contains("connection") ||
-        lowerError.contains("network") || lowerError.contains("unreachable")) {
-        qDebug() << "Detected offline state from error";
-        setOnline(false);
-        // Don't retry immediately when offline - wait for connectivity change
-        return;
+        SyncOperation op = sent.value(result.uuid);
+        outcomes.append(qMakePair(op, result));
+
+        // Permanent command errors fail at once rather than tying up the
+        // parked lane for MAX_RETRIES attempts
+        if (result.ok || !result.retryable || !retryOrDrop(op)) {
+            finished.append(op.uuid);
+        }
     }
 
-    // For other errors (e.g., server errors), increment retry count and try again later
-    if (!m_queue.isEmpty()) {
-        SyncOperation op = m_queue.peek();
-        op.retryCount++;
+    // Remove confirmed (and abandoned) operations before notifying listeners
+    m_queue.removeOperations(finished);
+
+    // Later operations on a just-created task must use its real ID
+    for (const auto& outcome : outcomes) {
+        const SyncOperation& op = outcome.first;
+        const CommandResult& result = outcome.second;
+        if (result.ok && op.type == "create_task") {
+            if (result.serverId.isEmpty()) {
+                qWarning() << "No server ID returned for created task" << op.tempId;
+            } else {
+                m_queue.replaceTaskId(op.tempId, result.serverId);
+            }
+        }
+    }
 
-        // Update the operation in the queue
-        m_queue.dequeue();
-        m_queue.enqueue(op);
-        m_queue.saveToFile();
+    // Confirmed online - the server answered
+    closeBreaker();
+    if (!m_authRejected) {
+        setSyncError(QString());
+    }
 
-        if (op.retryCount < 5) {
-            qDebug() << "Retrying operation after 2 seconds, attempt:" << (op.retryCount + 1);
-            m_retryTimer.start();
+    for (const auto& outcome : outcomes) {
+        const SyncOperation& op = outcome.first;
+        const CommandResult& result = outcome.second;
+
+        if (!result.ok) {
+            qWarning() << "Operation failed" << (result.retryable ? "(will retry):" : "permanently:")
+                       << op.type << op.uuid << "error:" << result.error;
+            emitFailure(op, result.error);
+        } else if (op.type == "close_task") {
+            qDebug() << "Task closed successfully:" << op.taskId;
+            emit syncSucceeded(op.taskId);
         } else {
-            qWarning() << "Operation failed after" << op.retryCount << "attempts, giving up";
-            // Remove failed operation
-            m_queue.dequeue();
-            m_queue.saveToFile();
-            // Try next operation
-            processNextOperation();
+            qDebug() << "Task created successfully:" << op.content << "serverTaskId:" << result.serverId;
+            emit taskCreateSynced(op.tempId, result.serverId);
+            if (op.closeAfterCreate) {
+                emit syncSucceeded(result.serverId);
+            }
         }
     }
+
+    // Refill the freed slot (and schedule the backed-off operations)
+    fillWindow();
 }
 
-void SyncManager::onTaskCreated(const QString& content, const QString& newTaskId)
+void SyncManager::onCommandsFailed(const QString& requestId, const QStringList& uuids, const NetworkError& error)
 {
-    if (content != m_currentSyncContent) {
-        qWarning() << "Received taskCreated for unexpected content:" << content << "expected:" << m_currentSyncContent;
+    if (!m_inFlightRequests.contains(requestId)) {
+        qWarning() << "Received failure for unknown request:" << requestId;
+        return;
+    }
+
+    qWarning() << "Batch" << requestId << "of" << uuids.size() << "operations failed ("
+               << NetworkError::categoryName(error.category) << "):" << error.message;
+
+    QVector<SyncOperation> failed = releaseRequest(requestId);
+    if (m_inFlightRequests.isEmpty()) {
+        setIsSyncing(false);
+    }
+
+    for (const SyncOperation& op : failed) {
+        emitFailure(op, error.message);
+    }
+
+    // Unreachable server: not the operations' fault, so their retry counts
+    // stay as they are and nothing more is sent until a probe succeeds
+    if (error.isConnectivity()) {
+        openBreaker(NetworkError::categoryName(error.category));
+        return;
+    }
+
+    // Rate limiting: the client has paused for Retry-After; the operations
+    // did nothing wrong, so they wait without using up an attempt
+    if (error.category == NetworkError::RateLimited) {
+        qint64 delayMs = error.retryAfterMs >= 0 ? error.retryAfterMs : backoffDelay(1);
+        for (const SyncOperation& op : failed) {
+            m_retryAt.insert(op.uuid, m_clock.elapsed() + delayMs);
+        }
+        fillWindow();
         return;
     }
 
-    qDebug() << "Task created successfully:" << content << "serverTaskId:" << newTaskId;
+    // Every request fails until the token changes; keep the queue for then
+    if (error.category == NetworkError::Auth) {
+        qWarning() << "API token rejected, pausing sync";
+        m_authRejected = true;
+        m_retryTimer.stop();
+        setSyncError(QString("Sync paused: %1").arg(error.message));
+        return;
+    }
 
-    // Get tempId before dequeue
-    QString tempId = m_currentSyncTaskId;
+    // Request too large: send the same operations in smaller batches; they
+    // did nothing wrong, so no attempt is used up
+    if (error.httpStatus == 413 && failed.size() > 1) {
+        m_batchLimit = qMax(1, qMin(m_batchLimit, failed.size()) / 2);
+        qDebug() << "Request too large, batches now hold at most" << m_batchLimit << "operations";
+        fillWindow();
+        return;
+    }
 
-    // Remove from queue (operation confirmed successful)
-    m_queue.dequeue();
-    m_queue.saveToFile();
+    // A rejected request or an unreadable answer (a captive portal page, a
+    // truncated body) says nothing about the operations themselves: they
+    // back off, get parked and are only given up after MAX_RETRIES
+    if (!error.isTransient()) {
+        setSyncError(QString("Changes not synced yet: %1").arg(error.message));
+    }
 
-    // Confirmed online
-    setOnline(true);
+    if (error.category == NetworkError::ServerError) {
+        ++m_consecutiveFailures;
+        if (m_breakerState == BreakerHalfOpen || m_consecutiveFailures >= BREAKER_FAILURE_THRESHOLD) {
+            openBreaker(QString("%1 consecutive failures").arg(m_consecutiveFailures));
+            return;
+        }
+    }
 
-    // Notify success with tempId and server-assigned ID
-    emit taskCreateSynced(tempId, newTaskId);
+    // Increment retry counts and try again later
+    QStringList abandoned;
+    for (const SyncOperation& op : failed) {
+        if (!retryOrDrop(op)) {
+            abandoned.append(op.uuid);
+        }
+    }
+    m_queue.removeOperations(abandoned);
 
-    // Process next operation
-    processNextOperation();
+    // Other operations can keep using the freed slot
+    fillWindow();
 }
 
-void SyncManager::onCreateTaskFailed(const QString& content, const QString& error)
+void SyncManager::onConnectivityProbed(bool reachable, qint64 rttMs)
 {
-    if (content != m_currentSyncContent) {
-        qWarning() << "Received createTaskFailed for unexpected content:" << content << "expected:" << m_currentSyncContent;
+    if (m_breakerState != BreakerOpen) {
         return;
     }
 
-    qWarning() << "Task create failed:" << content << "error:" << error;
+    if (!reachable) {
+        m_probeIntervalMs = qMin(m_probeIntervalMs * 2, PROBE_MAX_INTERVAL_MS);
+        qDebug() << "Server still unreachable, next probe in" << m_probeIntervalMs << "ms";
+        m_probeTimer.start(m_probeIntervalMs);
+        return;
+    }
 
-    setIsSyncing(false);
+    qDebug() << "Server reachable again (" << rttMs << "ms), sending a trial batch";
+    m_breakerState = BreakerHalfOpen;
+    setOnline(true);
+    fillWindow();
+}
 
-    // Get tempId for failure signal
-    QString tempId = m_currentSyncTaskId;
+void SyncManager::openBreaker(const QString& reason)
+{
+    m_retryTimer.stop();
+    if (m_breakerState != BreakerOpen) {
+        qDebug() << "Circuit breaker open:" << reason;
+        m_breakerState = BreakerOpen;
+        m_probeIntervalMs = PROBE_INITIAL_INTERVAL_MS;
+    }
 
-    // Emit failure signal
-    emit taskCreateSyncFailed(tempId, error);
+    setOnline(false);
+    m_probeTimer.start(m_probeIntervalMs);
+}
 
-    // Detect offline based on error message
-    QString lowerError = error.toLower();
-    if (lowerError.contains("timeout") || lowerError.contains("connection") ||
-        lowerError.contains("network") || lowerError.contains("unreachable")) {
-        qDebug() << "Detected offline state from error";
-        setOnline(false);
-        // Don't retry immediately when offline - wait for connectivity change
-        return;
+void SyncManager::closeBreaker()
+{
+    if (m_breakerState != BreakerClosed) {
+        qDebug() << "Circuit breaker closed";
+    }
+    m_breakerState = BreakerClosed;
+    m_consecutiveFailures = 0;
+    m_probeTimer.stop();
+    setOnline(true);
+}
+
+bool SyncManager::retryOrDrop(SyncOperation op)
+{
+    op.retryCount++;
+
+    if (op.retryCount >= MAX_RETRIES) {
+        qWarning() << "Operation" << op.uuid << "failed after" << op.retryCount << "attempts, giving up";
+        return false;
     }
 
-    // For other errors (e.g., server errors), increment retry count and try again later
-    if (!m_queue.isEmpty()) {
-        SyncOperation op = m_queue.peek();
-        op.retryCount++;
+    // Keep its place in the queue so later operations on the same task stay ordered
+    m_queue.updateOperation(op);
 
-        // Update the operation in the queue
-        m_queue.dequeue();
-        m_queue.enqueue(op);
-        m_queue.saveToFile();
+    qint64 delayMs = backoffDelay(op.retryCount);
+    m_retryAt.insert(op.uuid, m_clock.elapsed() + delayMs);
+    qDebug() << "Retrying" << op.uuid << "in" << delayMs << "ms (attempt" << op.retryCount + 1 << ")";
+    return true;
+}
 
-        if (op.retryCount < 5) {
-            qDebug() << "Retrying operation after 2 seconds, attempt:" << (op.retryCount + 1);
-            m_retryTimer.start();
-        } else {
-            qWarning() << "Operation failed after" << op.retryCount << "attempts, giving up";
-            // Remove failed operation
-            m_queue.dequeue();
-            m_queue.saveToFile();
-            // Try next operation
-            processNextOperation();
-        }
+qint64 SyncManager::backoffDelay(int attempt)
+{
+    // Equal jitter: half the exponential delay fixed, half random
+    qint64 ceiling = RETRY_MAX_DELAY_MS;
+    if (attempt <= 20) {
+        ceiling = qMin(RETRY_MAX_DELAY_MS, RETRY_BASE_DELAY_MS << qMax(0, attempt - 1));
+    }
+    return ceiling / 2 + QRandomGenerator::global()->bounded(ceiling / 2 + 1);
+}
+
+void SyncManager::forgetRetries(const QStringList& uuids)
+{
+    for (const QString& uuid : uuids) {
+        m_retryAt.remove(uuid);
+    }
+}
+
+void SyncManager::scheduleWake(qint64 delayMs)
+{
+    int ms = static_cast<int>(qBound<qint64>(0, delayMs, RETRY_MAX_DELAY_MS));
+    if (!m_retryTimer.isActive() || m_retryTimer.remainingTime() > ms) {
+        m_retryTimer.start(ms);
+    }
+}
+
+void SyncManager::emitFailure(const SyncOperation& op, const QString& error)
+{
+    if (op.type == "create_task") {
+        emit taskCreateSyncFailed(op.tempId, error);
+    } else {
+        emit syncFailed(op.taskId, error);
     }
 }
 
@@ -321,13 +686,18 @@ void SyncManager::onReachabilityChanged()
     bool online = (netInfo->reachability() == QNetworkInformation::Reachability::Online);
     qDebug() << "Network reachability changed, online:" << online;
 
-    bool wasOnline = m_isOnline;
-    setOnline(online);
+    if (!online) {
+        openBreaker("network lost");
+        return;
+    }
+
+    // Have a connection ready for the backlog (or the probe) that follows
+    m_client->warmUp();
 
-    // If we just came online and have pending operations, start retry timer
-    if (online && !wasOnline && !m_queue.isEmpty()) {
-        qDebug() << "Connectivity restored, scheduling sync in 2 seconds";
-        m_retryTimer.start();
+    // Link is up; confirm the server answers before sending anything
+    if (m_breakerState == BreakerOpen) {
+        m_probeTimer.stop();
+        m_client->probeConnectivity();
     }
 }
 
@@ -340,6 +710,14 @@ void SyncManager::setOnline(bool online)
     }
 }
 
+void SyncManager::setSyncError(const QString& error)
+{
+    if (m_syncError != error) {
+        m_syncError = error;
+        emit syncErrorChanged();
+    }
+}
+
 void SyncManager::setIsSyncing(bool syncing)
 {
     if (m_isSyncing != syncing) {
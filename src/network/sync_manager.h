@@ -3,17 +3,47 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QHash>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
 #include "../models/sync_queue.h"
+#include "todoist_client.h"  // CommandResult
 
-class TodoistClient;
 class QNetworkInformation;
 
+/**
+ * @brief Sends queued operations to Todoist and tracks connectivity.
+ *
+ * A circuit breaker guards the request window. Connectivity failures (and
+ * a run of server errors) open it: nothing is sent and isOnline turns
+ * false, while TodoistClient::probeConnectivity() checks the host on a
+ * growing interval. A successful probe half-opens the breaker and lets a
+ * single batch through; if that succeeds the window reopens fully.
+ *
+ * A failed operation waits out an exponential backoff with jitter before
+ * it is sent again; a 429 waits for its Retry-After instead. A rejected or
+ * unreadable request is retried the same way, since only a per-command
+ * error in sync_status says an operation itself is bad; a 413 shrinks the
+ * batches instead. A command error fails its operation at once unless it
+ * is a 429 or a server-side (5xx) error. Batches are only sent while TodoistClient's rate
+ * limiter has room.
+ *
+ * Requests come from three lanes. Operations the user queued in the last
+ * few seconds are looked up directly and sent first, with a request slot
+ * and rate-limit tokens of their own, so they are not held up by a
+ * backlog drain. The background lane drains the queue in order. An
+ * operation that has failed several times is parked: it is sent on its
+ * own, one at a time, so it cannot hold up or fail other batches.
+ */
 class SyncManager : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(bool isOnline READ isOnline NOTIFY isOnlineChanged)
     Q_PROPERTY(int pendingCount READ pendingCount NOTIFY pendingCountChanged)
     Q_PROPERTY(bool isSyncing READ isSyncing NOTIFY isSyncingChanged)
+    Q_PROPERTY(QString syncError READ syncError NOTIFY syncErrorChanged)
 
 public:
     explicit SyncManager(TodoistClient* client, QObject* parent = nullptr);
@@ -22,6 +52,7 @@ public:
     bool isOnline() const { return m_isOnline; }
     int pendingCount() const { return m_queue.count(); }
     bool isSyncing() const { return m_isSyncing; }
+    QString syncError() const { return m_syncError; }  // Why operations stopped or were dropped; empty while syncing works
 
     // Queue a task completion operation
     void queueTaskCompletion(const QString& taskId);
@@ -32,27 +63,62 @@ public:
     // Process pending operations (call when you think we're online)
     void processQueue();
 
+    // Number of batch requests allowed in flight at once
+    void setMaxInFlight(int maxRequests);
+
 signals:
     void isOnlineChanged();
     void pendingCountChanged();
     void isSyncingChanged();
+    void syncErrorChanged();
     void syncSucceeded(const QString& taskId);
     void syncFailed(const QString& taskId, const QString& error);
+    void taskCreateQueued(const QString& tempId);  // The create is on disk and survives a restart
     void taskCreateSynced(const QString& tempId, const QString& serverTaskId);
     void taskCreateSyncFailed(const QString& tempId, const QString& error);
 
 private slots:
-    void onTaskClosed(const QString& taskId);
-    void onCloseTaskFailed(const QString& taskId, const QString& error);
-    void onTaskCreated(const QString& content, const QString& newTaskId);
-    void onCreateTaskFailed(const QString& content, const QString& error);
+    void onCommandsCompleted(const QString& requestId, const QVector<CommandResult>& results);
+    void onCommandsFailed(const QString& requestId, const QStringList& uuids, const NetworkError& error);
+    void onConnectivityProbed(bool reachable, qint64 rttMs);
+    void onOperationsPersisted(const QStringList& uuids);
     void onReachabilityChanged();
-    void processNextOperation();
+    void fillWindow();
 
 private:
     void initializeNetworkMonitoring();
     void setOnline(bool online);
     void setIsSyncing(bool syncing);
+    void setSyncError(const QString& error);
+
+    // Request lanes, filled in this order by fillWindow()
+    enum Lane {
+        InteractiveLane,  // Queued by the user in the last few seconds
+        BackgroundLane,   // Backlog and retries, in queue order
+        ParkedLane        // Failed repeatedly: alone, one request at a time
+    };
+    void sendInteractive();
+    void sendBackground();
+    bool sendBatch(const QVector<SyncOperation>& batch, Lane lane);  // False if rate limited
+    static const char* laneName(Lane lane);
+    void emitFailure(const SyncOperation& op, const QString& error);
+    QVector<SyncOperation> releaseRequest(const QString& requestId);
+    static QString orderingKey(const SyncOperation& op);
+    bool retryOrDrop(SyncOperation op);  // Returns true if the operation stays queued
+
+    // Per-operation retry backoff
+    static qint64 backoffDelay(int attempt);  // Exponential with jitter
+    void forgetRetries(const QStringList& uuids);
+    void scheduleWake(qint64 delayMs);  // Run fillWindow() again after at most this long
+
+    // Circuit breaker
+    enum BreakerState {
+        BreakerClosed,    // Requests flow normally
+        BreakerOpen,      // Server unreachable; only probes are sent
+        BreakerHalfOpen   // Probe succeeded; one trial batch at a time
+    };
+    void openBreaker(const QString& reason);
+    void closeBreaker();
 
     TodoistClient* m_client;
     SyncQueue m_queue;
@@ -61,8 +127,24 @@ private:
     bool m_isOnline;
     bool m_isSyncing;
     bool m_useNetworkInfo;        // Whether QNetworkInformation is available
-    QString m_currentSyncTaskId;  // Task currently being synced
-    QString m_currentSyncContent; // Content of current sync operation (for create_task)
+    bool m_authRejected;          // Token refused: nothing is sent until it changes (restart)
+    QString m_syncError;
+    int m_maxInFlight;                                        // Request window size
+    int m_batchLimit;                                         // Operations per request; halved by a 413
+    QHash<QString, QVector<SyncOperation>> m_inFlightRequests; // requestId -> batch
+    QSet<QString> m_inFlightUuids;                            // Operations awaiting a response
+    QSet<QString> m_inFlightKeys;                             // Tasks with an operation in flight
+    QElapsedTimer m_drainTimer;                               // Time since the backlog drain began
+    QElapsedTimer m_clock;                                    // Time base for m_retryAt
+    QHash<QString, qint64> m_retryAt;                         // uuid -> earliest next attempt (in memory only)
+    QList<QPair<QString, qint64>> m_interactive;              // Fresh uuids and when they were queued
+    QSet<QString> m_parkedRequests;                           // In-flight requests from the parked lane
+    QHash<QString, QString> m_createsAwaitingDisk;            // uuid -> tempId until the create is persisted
+
+    BreakerState m_breakerState;
+    int m_consecutiveFailures;  // Transient batch failures since the last success
+    int m_probeIntervalMs;      // Next probe delay while the breaker is open
+    QTimer m_probeTimer;
 };
 
 #endif // SYNC_MANAGER_H
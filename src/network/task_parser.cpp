@@ -0,0 +1,182 @@
+#include "task_parser.h"
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QDebug>
+
+TaskParser::TaskParser(QObject* parent)
+    : QObject(parent)
+{
+}
+
+Task TaskParser::taskFromJson(const QJsonObject& obj) const
+{
+    Task task = Task::fromJson(obj);
+
+    // Look up project name from cache (handle to handle, no string hashing)
+    task.projectNameHandle = m_projectNameHandles.value(task.projectIdHandle, 0);
+
+    return task;
+}
+
+void TaskParser::updateProjectHandles()
+{
+    m_projectNameHandles.clear();
+    m_projectNameHandles.reserve(m_projectNames.size());
+    for (auto it = m_projectNames.cbegin(); it != m_projectNames.cend(); ++it) {
+        m_projectNameHandles.insert(StringTable::intern(it.key()), StringTable::intern(it.value()));
+    }
+}
+
+void TaskParser::beginTasks(quint64 jobId)
+{
+    m_taskStreams.insert(jobId, TaskStream());
+}
+
+void TaskParser::feedTasks(quint64 jobId, const QByteArray& chunk)
+{
+    auto it = m_taskStreams.find(jobId);
+    if (it == m_taskStreams.end()) {
+        return;  // Aborted
+    }
+
+    QVector<Task> batch;
+    for (const QJsonObject& obj : it->parser.feed(chunk)) {
+        Task task = taskFromJson(obj);
+        task.sourceOrder = it->tasks.size() + batch.size();
+        batch.append(task);
+    }
+
+    if (!batch.isEmpty()) {
+        it->tasks += batch;
+        emit tasksParsed(jobId, batch);
+    }
+}
+
+void TaskParser::finishTasks(quint64 jobId)
+{
+    if (!m_taskStreams.contains(jobId)) {
+        return;  // Aborted
+    }
+
+    // Take the stream out so the emitted vector is the only remaining reference
+    TaskStream stream = m_taskStreams.take(jobId);
+
+    QString error;
+    if (stream.parser.hasError()) {
+        error = QString("Failed to parse tasks response: %1").arg(stream.parser.errorString());
+    } else if (!stream.parser.isFinished()) {
+        error = "Failed to parse tasks response: Truncated response";
+    }
+
+    emit tasksFinished(jobId, error.isEmpty() ? std::move(stream.tasks) : QVector<Task>(), error);
+}
+
+void TaskParser::abortTasks(quint64 jobId)
+{
+    m_taskStreams.remove(jobId);
+}
+
+void TaskParser::parseProjects(quint64 jobId, const QByteArray& body)
+{
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(body, &parseError);
+
+    if (parseError.error != QJsonParseError::NoError) {
+        QString errorMsg = QString("Failed to parse projects response: %1").arg(parseError.errorString());
+        emit projectsParsed(jobId, m_projectNames, errorMsg);
+        return;
+    }
+
+    // Parse projects array and update cache
+    m_projectNames.clear();
+    QJsonArray projectsArray = doc.array();
+
+    for (const QJsonValue& value : projectsArray) {
+        if (value.isObject()) {
+            QJsonObject projectObj = value.toObject();
+            QString id = projectObj["id"].toString();
+            QString name = projectObj["name"].toString();
+
+            if (!id.isEmpty()) {
+                m_projectNames.insert(id, name);
+            }
+        }
+    }
+    updateProjectHandles();
+
+    emit projectsParsed(jobId, m_projectNames, QString());
+}
+
+void TaskParser::setProjectNames(const QMap<QString, QString>& projectNames)
+{
+    m_projectNames = projectNames;
+    updateProjectHandles();
+}
+
+void TaskParser::parseSync(quint64 jobId, const QByteArray& body, bool requestedFullSync)
+{
+    SyncDelta delta;
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(body, &parseError);
+
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        QString errorMsg = QString("Failed to parse sync response: %1").arg(parseError.errorString());
+        emit syncParsed(jobId, delta, errorMsg);
+        return;
+    }
+
+    QJsonObject root = doc.object();
+    delta.syncToken = root["sync_token"].toString();
+    delta.fullSync = root["full_sync"].toBool(requestedFullSync);
+
+    // Apply project changes to the cache first so task names resolve below
+    QJsonArray projectsArray = root["projects"].toArray();
+    if (delta.fullSync) {
+        m_projectNames.clear();
+    }
+    for (const QJsonValue& value : projectsArray) {
+        QJsonObject projectObj = value.toObject();
+        QString id = projectObj["id"].toString();
+        if (id.isEmpty()) {
+            continue;
+        }
+
+        if (projectObj["is_deleted"].toBool(false) || projectObj["is_archived"].toBool(false)) {
+            m_projectNames.remove(id);
+        } else {
+            m_projectNames.insert(id, projectObj["name"].toString());
+        }
+    }
+    delta.projectsChanged = delta.fullSync || !projectsArray.isEmpty();
+    if (delta.projectsChanged) {
+        updateProjectHandles();
+    }
+    delta.projectNames = m_projectNames;
+
+    // Items: deleted and completed tasks leave the list, everything else is an upsert
+    QJsonArray itemsArray = root["items"].toArray();
+    delta.tasks.reserve(itemsArray.size());
+    for (const QJsonValue& value : itemsArray) {
+        if (!value.isObject()) {
+            continue;
+        }
+
+        QJsonObject itemObj = value.toObject();
+        Task task = taskFromJson(itemObj);
+        if (task.id.isEmpty()) {
+            continue;
+        }
+
+        if (itemObj["is_deleted"].toBool(false) || task.completed) {
+            delta.removedTaskIds.append(task.id);
+            continue;
+        }
+
+        task.sourceOrder = delta.tasks.size();
+        delta.tasks.append(task);
+    }
+
+    emit syncParsed(jobId, delta, QString());
+}
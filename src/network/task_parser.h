@@ -0,0 +1,84 @@
+#ifndef TASK_PARSER_H
+#define TASK_PARSER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QVector>
+#include <QStringList>
+#include "../models/task.h"
+#include "json_array_stream.h"
+
+/**
+ * @brief Result of a Sync API request, applied by the caller as a patch.
+ *
+ * When fullSync is true the tasks vector holds the complete task list and
+ * replaces any local state; otherwise it only holds added/changed tasks.
+ */
+struct SyncDelta {
+    QVector<Task> tasks;                 // Added or changed active tasks
+    QStringList removedTaskIds;          // Deleted or completed since last sync
+    QMap<QString, QString> projectNames; // Full projectId -> projectName cache
+    bool projectsChanged;                // Whether any project was added/renamed/removed
+    bool fullSync;                       // Server sent everything (token was "*" or reset)
+    QString syncToken;                   // Token to send with the next delta sync
+
+    SyncDelta() : projectsChanged(false), fullSync(false) {}
+};
+
+/**
+ * @brief Worker that turns Todoist API response bodies into Tasks.
+ *
+ * Lives on TodoistClient's parser thread so JSON parsing, Task::fromJson
+ * and project-name lookups never run on the GUI thread. All slots are
+ * invoked with queued calls; every job carries an ID chosen by the caller
+ * and results come back through the signals below with the same ID.
+ *
+ * The worker owns the projectId -> projectName cache used to fill in
+ * Task::projectName, updated by parseProjects() and parseSync().
+ */
+class TaskParser : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TaskParser(QObject* parent = nullptr);
+
+public slots:
+    // Streamed REST task list: begin, feed body chunks, then finish or abort
+    void beginTasks(quint64 jobId);
+    void feedTasks(quint64 jobId, const QByteArray& chunk);
+    void finishTasks(quint64 jobId);
+    void abortTasks(quint64 jobId);
+
+    // REST project list (replaces the project cache)
+    void parseProjects(quint64 jobId, const QByteArray& body);
+
+    // Sync API response (patches the project cache)
+    void parseSync(quint64 jobId, const QByteArray& body, bool requestedFullSync);
+
+    // Replace the project cache without a request (e.g. from a saved snapshot)
+    void setProjectNames(const QMap<QString, QString>& projectNames);
+
+signals:
+    void tasksParsed(quint64 jobId, const QVector<Task>& tasks);
+    void tasksFinished(quint64 jobId, const QVector<Task>& tasks, const QString& error);
+    void projectsParsed(quint64 jobId, const QMap<QString, QString>& projects, const QString& error);
+    void syncParsed(quint64 jobId, const SyncDelta& delta, const QString& error);
+
+private:
+    Task taskFromJson(const QJsonObject& obj) const;
+    void updateProjectHandles();
+
+    struct TaskStream {
+        JsonArrayStream parser;
+        QVector<Task> tasks;  // Everything parsed so far
+    };
+
+    QHash<quint64, TaskStream> m_taskStreams;
+    QMap<QString, QString> m_projectNames;  // projectId -> projectName cache
+    QHash<StringTable::Handle, StringTable::Handle> m_projectNameHandles;  // Same cache, interned
+};
+
+#endif // TASK_PARSER_H
@@ -2,32 +2,276 @@
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QUrl>
+#include <QUuid>
+#include <QThread>
 #include <QDebug>
+#if QT_CONFIG(ssl)
+#include <QSslConfiguration>
+#endif
 
-// API endpoints
-static const QString TASKS_ENDPOINT = "https://api.todoist.com/rest/v2/tasks";
-static const QString PROJECTS_ENDPOINT = "https://api.todoist.com/rest/v2/projects";
+// Default API host (overridable for the local mock server)
+static const QString DEFAULT_BASE_URL = "https://api.todoist.com";
 
-// Request timeout in milliseconds (30 seconds)
-static const int REQUEST_TIMEOUT_MS = 30000;
+// API endpoint paths
+static const QString TASKS_PATH = "/rest/v2/tasks";
+static const QString PROJECTS_PATH = "/rest/v2/projects";
+static const QString SYNC_PATH = "/sync/v9/sync";
+
+// Sync API resources needed to build the task list
+static const QString SYNC_RESOURCE_TYPES = "[\"items\",\"projects\"]";
+
+// Transfer timeout bounds; the value in between follows measured response times
+static const int MIN_REQUEST_TIMEOUT_MS = 5000;
+static const int MAX_REQUEST_TIMEOUT_MS = 30000;
+
+// Timeout as a multiple of the retransmission-style estimate (srtt + 4 * rttvar),
+// leaving room for server time on larger responses
+static const int TIMEOUT_RTO_MULTIPLIER = 3;
+
+// Connectivity probes are tiny; don't wait long for one
+static const int PROBE_TIMEOUT_MS = 5000;
+
+// Command requests: Todoist allows 450 partial syncs per 15 minutes (0.5/s);
+// a small burst lets a fresh action go out immediately
+static const double RATE_LIMIT_BURST = 10;
+static const double RATE_LIMIT_PER_SECOND = 0.5;
+
+// A connection used this recently is assumed still open; warmUp() skips it
+static const qint64 WARM_CONNECTION_MS = 30000;
+
+// Tokens a backlog drain leaves in the bucket for fresh user actions
+static const int INTERACTIVE_RESERVED_REQUESTS = 2;
+
+// Pause after a 429 that came without a usable Retry-After
+static const qint64 DEFAULT_RETRY_AFTER_MS = 30000;
+
+// UUID of the item_close sent with a create-as-completed operation.
+// Derived from the operation so a retried batch is still de-duplicated.
+static QString closeCommandUuid(const SyncOperation& op)
+{
+    return QUuid::createUuidV5(QUuid(op.uuid), QStringLiteral("item_close")).toString(QUuid::WithoutBraces);
+}
+
+// A sync_status entry is "ok" or {"error_code": ..., "error": "...", "http_code": ...}.
+// Only a 429 or 5xx http_code, or a missing entry, is worth sending again;
+// anything else (invalid argument, item not found) fails the same way every time
+static bool commandSucceeded(const QJsonValue& status, QString* error, bool* retryable)
+{
+    if (status.toString() == "ok") {
+        return true;
+    }
+    if (!status.isObject()) {
+        *error = QString("No status returned for command");
+        *retryable = true;
+        return false;
+    }
+
+    QJsonObject details = status.toObject();
+    int httpCode = details["http_code"].toInt();
+    *error = details["error"].toString();
+    *retryable = httpCode == 429 || httpCode >= 500;
+    return false;
+}
 
 TodoistClient::TodoistClient(const QString& apiToken, QObject* parent)
     : QObject(parent)
     , m_apiToken(apiToken)
+    , m_baseUrl(DEFAULT_BASE_URL)
+    , m_nextJobId(0)
+    , m_readGeneration(0)
+    , m_srttMs(-1)
+    , m_rttVarMs(0)
+    , m_probeReply(nullptr)
+    , m_lastConnectionUseMs(-1)
+    , m_rateLimiter(RATE_LIMIT_BURST, RATE_LIMIT_PER_SECOND)
 {
+    qRegisterMetaType<NetworkError>();
+    m_clock.start();
+
     m_networkManager = new QNetworkAccessManager(this);
+
+    // Response parsing runs on its own thread to keep the UI responsive
+    m_parserThread = new QThread(this);
+    m_parserThread->setObjectName("TodoistParser");
+    m_parser = new TaskParser();
+    m_parser->moveToThread(m_parserThread);
+    connect(m_parserThread, &QThread::finished, m_parser, &QObject::deleteLater);
+
+    connect(m_parser, &TaskParser::tasksParsed, this, &TodoistClient::onTasksParsed);
+    connect(m_parser, &TaskParser::tasksFinished, this, &TodoistClient::onTasksFinished);
+    connect(m_parser, &TaskParser::projectsParsed, this, &TodoistClient::onProjectsParsed);
+    connect(m_parser, &TaskParser::syncParsed, this, &TodoistClient::onSyncParsed);
+
+    m_parserThread->start();
+}
+
+TodoistClient::~TodoistClient()
+{
+    m_parserThread->quit();
+    m_parserThread->wait();
+}
+
+void TodoistClient::setApiBaseUrl(const QString& baseUrl)
+{
+    m_baseUrl = baseUrl.isEmpty() ? DEFAULT_BASE_URL : baseUrl;
+    qDebug() << "Using Todoist API at" << m_baseUrl;
+}
+
+void TodoistClient::setProjectNames(const QMap<QString, QString>& projectNames)
+{
+    m_projectNames = projectNames;
+    QMetaObject::invokeMethod(m_parser, [parser = m_parser, projectNames]() {
+        parser->setProjectNames(projectNames);
+    }, Qt::QueuedConnection);
+}
+
+QUrl TodoistClient::apiUrl(const QString& path) const
+{
+    return QUrl(m_baseUrl + path);
+}
+
+QNetworkRequest TodoistClient::authorizedRequest(const QString& path, const QString& requestId) const
+{
+    QNetworkRequest request(apiUrl(path));
+    request.setRawHeader("Authorization", QString("Bearer %1").arg(m_apiToken).toUtf8());
+    request.setTransferTimeout(requestTimeout());
+
+    // One multiplexed HTTP/2 connection (when the server offers it) instead of several HTTP/1 ones
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+
+    // Todoist echoes X-Request-Id and uses it to de-duplicate retried writes
+    if (!requestId.isEmpty()) {
+        request.setRawHeader("X-Request-Id", requestId.toUtf8());
+    }
+    return request;
+}
+
+int TodoistClient::requestTimeout() const
+{
+    if (m_srttMs < 0) {
+        return MAX_REQUEST_TIMEOUT_MS;  // Nothing measured yet
+    }
+    qint64 rto = m_srttMs + 4 * m_rttVarMs;
+    return static_cast<int>(qBound<qint64>(MIN_REQUEST_TIMEOUT_MS, rto * TIMEOUT_RTO_MULTIPLIER,
+                                           MAX_REQUEST_TIMEOUT_MS));
+}
+
+void TodoistClient::recordRtt(qint64 rttMs)
+{
+    // RFC 6298 smoothing: srtt gains 1/8 of the error, rttvar 1/4
+    if (m_srttMs < 0) {
+        m_srttMs = rttMs;
+        m_rttVarMs = rttMs / 2;
+    } else {
+        qint64 deviation = qAbs(m_srttMs - rttMs);
+        m_rttVarMs = (3 * m_rttVarMs + deviation) / 4;
+        m_srttMs = (7 * m_srttMs + rttMs) / 8;
+    }
+}
+
+void TodoistClient::trackLatency(QNetworkReply* reply)
+{
+    // Timestamps of each phase; connecting/encrypted only fire for a new connection
+    m_lastConnectionUseMs = m_clock.elapsed();
+    reply->setProperty("sentAt", m_lastConnectionUseMs);
+
+    connect(reply, &QNetworkReply::socketStartedConnecting, this, [this, reply]() {
+        reply->setProperty("connectingAt", m_clock.elapsed());
+    });
+#if QT_CONFIG(ssl)
+    connect(reply, &QNetworkReply::encrypted, this, [this, reply]() {
+        reply->setProperty("encryptedAt", m_clock.elapsed());
+    });
+#endif
+    connect(reply, &QNetworkReply::requestSent, this, [this, reply]() {
+        reply->setProperty("requestSentAt", m_clock.elapsed());
+    });
+    connect(reply, &QNetworkReply::metaDataChanged, this, [this, reply]() {
+        if (reply->property("headersAt").isValid()) {
+            return;
+        }
+        qint64 now = m_clock.elapsed();
+        reply->setProperty("headersAt", now);
+
+        // Server response time, excluding any handshake, drives the adaptive timeout
+        QVariant requestSentAt = reply->property("requestSentAt");
+        recordRtt(now - (requestSentAt.isValid() ? requestSentAt : reply->property("sentAt")).toLongLong());
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        logTiming(reply);
+    });
+}
+
+void TodoistClient::logTiming(QNetworkReply* reply)
+{
+    qint64 finishedAt = m_clock.elapsed();
+    m_lastConnectionUseMs = finishedAt;
+
+    if (!reply->property("requestSentAt").isValid() || !reply->property("headersAt").isValid()) {
+        return;  // Failed before a response; nothing meaningful to split
+    }
+    qint64 sentAt = reply->property("sentAt").toLongLong();
+    qint64 requestSentAt = reply->property("requestSentAt").toLongLong();
+    qint64 headersAt = reply->property("headersAt").toLongLong();
+
+    // Handshake: DNS, TCP and TLS on a new connection; nothing on a reused one
+    bool newConnection = reply->property("connectingAt").isValid();
+    qint64 handshakeMs = newConnection ? requestSentAt - reply->property("connectingAt").toLongLong() : 0;
+
+    qDebug().nospace() << "Timing " << reply->request().url().path() << ": "
+                       << (newConnection ? "new" : "reused") << " connection, handshake " << handshakeMs
+                       << " ms, queued " << (requestSentAt - sentAt - handshakeMs)
+                       << " ms, server " << (headersAt - requestSentAt)
+                       << " ms, transfer " << (finishedAt - headersAt) << " ms, HTTP/2 "
+                       << reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool();
+}
+
+void TodoistClient::warmUp()
+{
+    qint64 now = m_clock.elapsed();
+    if (m_lastConnectionUseMs >= 0 && now - m_lastConnectionUseMs < WARM_CONNECTION_MS) {
+        return;  // Recently used; the keep-alive connection should still be open
+    }
+    m_lastConnectionUseMs = now;
+
+    QUrl url = apiUrl("/");
+    if (url.scheme() == "https") {
+#if QT_CONFIG(ssl)
+        // Offer HTTP/2 so the warmed connection is the one requests multiplex over
+        QSslConfiguration config = QSslConfiguration::defaultConfiguration();
+        config.setAllowedNextProtocols({QSslConfiguration::ALPNProtocolHTTP2,
+                                        QSslConfiguration::ALPNProtocolHTTP1_1});
+        m_networkManager->connectToHostEncrypted(url.host(), static_cast<quint16>(url.port(443)), config);
+#endif
+    } else {
+        m_networkManager->connectToHost(url.host(), static_cast<quint16>(url.port(80)));
+    }
+    qDebug() << "Warming up connection to" << url.host();
+}
+
+QString TodoistClient::newRequestId()
+{
+    return QUuid::createUuid().toString(QUuid::WithoutBraces);
 }
 
 void TodoistClient::fetchAllTasks()
 {
     qDebug() << "Fetching tasks from Todoist API...";
 
-    QUrl url(TASKS_ENDPOINT);
-    QNetworkRequest request(url);
-    request.setRawHeader("Authorization", QString("Bearer %1").arg(m_apiToken).toUtf8());
-    request.setTransferTimeout(REQUEST_TIMEOUT_MS);
+    QNetworkRequest request = authorizedRequest(TASKS_PATH);
 
+    // Parse as the body streams in so rows can appear before the download finishes
     QNetworkReply* reply = m_networkManager->get(request);
+    trackLatency(reply);
+    trackRead(reply);
+    quint64 jobId = ++m_nextJobId;
+    m_taskJobs.insert(reply, jobId);
+    m_jobGenerations.insert(jobId, m_readGeneration);
+    QMetaObject::invokeMethod(m_parser, [parser = m_parser, jobId]() {
+        parser->beginTasks(jobId);
+    }, Qt::QueuedConnection);
+    connect(reply, &QNetworkReply::readyRead, this, &TodoistClient::onTasksReadyRead);
     connect(reply, &QNetworkReply::finished, this, &TodoistClient::onTasksReplyFinished);
 }
 
@@ -35,48 +279,145 @@ void TodoistClient::fetchProjects()
 {
     qDebug() << "Fetching projects from Todoist API...";
 
-    QUrl url(PROJECTS_ENDPOINT);
-    QNetworkRequest request(url);
-    request.setRawHeader("Authorization", QString("Bearer %1").arg(m_apiToken).toUtf8());
-    request.setTransferTimeout(REQUEST_TIMEOUT_MS);
+    QNetworkRequest request = authorizedRequest(PROJECTS_PATH);
 
     QNetworkReply* reply = m_networkManager->get(request);
+    trackLatency(reply);
+    trackRead(reply);
     connect(reply, &QNetworkReply::finished, this, &TodoistClient::onProjectsReplyFinished);
 }
 
-void TodoistClient::closeTask(const QString& taskId)
+void TodoistClient::syncResources(const QString& syncToken)
 {
-    qDebug() << "Closing task" << taskId << "via Todoist API...";
+    qDebug() << "Syncing with Todoist Sync API, full sync:" << (syncToken == "*");
 
-    QString urlString = QString("https://api.todoist.com/rest/v2/tasks/%1/close").arg(taskId);
-    QUrl url(urlString);
-    QNetworkRequest request(url);
-    request.setRawHeader("Authorization", QString("Bearer %1").arg(m_apiToken).toUtf8());
-    request.setTransferTimeout(REQUEST_TIMEOUT_MS);
+    QNetworkRequest request = authorizedRequest(SYNC_PATH);
+    request.setRawHeader("Content-Type", "application/x-www-form-urlencoded");
+
+    // Form-encode by hand: QUrlQuery leaves '+' unescaped, which servers read as a space
+    QByteArray body = "sync_token=" + QUrl::toPercentEncoding(syncToken)
+                    + "&resource_types=" + QUrl::toPercentEncoding(SYNC_RESOURCE_TYPES);
 
-    // POST with empty body (required by Qt for bodyless POST)
-    QNetworkReply* reply = m_networkManager->post(request, QByteArray());
-    connect(reply, &QNetworkReply::finished, this, &TodoistClient::onCloseTaskReplyFinished);
+    QNetworkReply* reply = m_networkManager->post(request, body);
+    trackLatency(reply);
+    trackRead(reply);
+    reply->setProperty("syncToken", syncToken);  // Needed to detect token invalidation
+    connect(reply, &QNetworkReply::finished, this, &TodoistClient::onSyncReplyFinished);
 }
 
-void TodoistClient::createTask(const QString& content)
+QString TodoistClient::submitCommands(const QVector<SyncOperation>& operations)
 {
-    qDebug() << "Creating task via Todoist API:" << content;
+    QString requestId = newRequestId();
+    qDebug() << "Submitting" << operations.size() << "commands via Todoist Sync API, request:" << requestId;
+
+    QJsonArray commands;
+    for (const SyncOperation& op : operations) {
+        QJsonObject command;
+        QJsonObject args;
+        command["uuid"] = op.uuid;
+
+        if (op.type == "close_task") {
+            command["type"] = "item_close";
+            args["id"] = op.taskId;
+        } else if (op.type == "create_task") {
+            command["type"] = "item_add";
+            command["temp_id"] = op.tempId;
+            args["content"] = op.content;
+        } else {
+            qWarning() << "submitCommands: skipping unknown operation type" << op.type;
+            continue;
+        }
 
-    QUrl url(TASKS_ENDPOINT);
-    QNetworkRequest request(url);
-    request.setRawHeader("Authorization", QString("Bearer %1").arg(m_apiToken).toUtf8());
-    request.setRawHeader("Content-Type", "application/json");
-    request.setTransferTimeout(REQUEST_TIMEOUT_MS);
+        command["args"] = args;
+        commands.append(command);
+
+        // Coalesced close: the temp ID resolves within the same request
+        if (op.type == "create_task" && op.closeAfterCreate) {
+            QJsonObject closeArgs;
+            closeArgs["id"] = op.tempId;
+
+            QJsonObject close;
+            close["type"] = "item_close";
+            close["uuid"] = closeCommandUuid(op);
+            close["args"] = closeArgs;
+            commands.append(close);
+        }
+    }
+
+    QNetworkRequest request = authorizedRequest(SYNC_PATH, requestId);
+    request.setRawHeader("Content-Type", "application/x-www-form-urlencoded");
+
+    QByteArray commandsJson = QJsonDocument(commands).toJson(QJsonDocument::Compact);
+    QByteArray body = "commands=" + QUrl::toPercentEncoding(QString::fromUtf8(commandsJson));
+
+    QNetworkReply* reply = m_networkManager->post(request, body);
+    trackLatency(reply);
+    reply->setProperty("requestId", requestId);
+    m_commandBatches.insert(reply, operations);
+    connect(reply, &QNetworkReply::finished, this, &TodoistClient::onCommandsReplyFinished);
+    return requestId;
+}
+
+bool TodoistClient::tryAcquireRequest(qint64* waitMs, bool interactive)
+{
+    return m_rateLimiter.tryAcquire(waitMs, interactive ? 0 : INTERACTIVE_RESERVED_REQUESTS);
+}
+
+void TodoistClient::cancelReads()
+{
+    ++m_readGeneration;
+
+    // abort() finishes each reply synchronously; the handlers see the old generation
+    const QList<QNetworkReply*> replies = m_readReplies.values();
+    if (!replies.isEmpty()) {
+        qDebug() << "Aborting" << replies.size() << "superseded requests";
+    }
+    for (QNetworkReply* reply : replies) {
+        reply->abort();
+    }
+}
+
+void TodoistClient::trackRead(QNetworkReply* reply)
+{
+    reply->setProperty("generation", m_readGeneration);
+    m_readReplies.insert(reply);
+}
+
+bool TodoistClient::finishRead(QNetworkReply* reply)
+{
+    m_readReplies.remove(reply);
+    return reply->property("generation").toULongLong() == m_readGeneration;
+}
+
+bool TodoistClient::finishJob(quint64 jobId)
+{
+    auto it = m_jobGenerations.find(jobId);
+    if (it == m_jobGenerations.end()) {
+        return false;
+    }
+    bool current = it.value() == m_readGeneration;
+    m_jobGenerations.erase(it);
+    return current;
+}
+
+void TodoistClient::onTasksReadyRead()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    if (!reply || !m_taskJobs.contains(reply)) {
+        return;
+    }
 
-    // Build JSON body
-    QJsonObject jsonObj;
-    jsonObj["content"] = content;
-    QJsonDocument doc(jsonObj);
-    QByteArray jsonData = doc.toJson(QJsonDocument::Compact);
+    // Error bodies are not task arrays - leave them for onTasksReplyFinished
+    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (statusCode != 200) {
+        return;
+    }
 
-    QNetworkReply* reply = m_networkManager->post(request, jsonData);
-    connect(reply, &QNetworkReply::finished, this, &TodoistClient::onCreateTaskReplyFinished);
+    quint64 jobId = m_taskJobs.value(reply);
+    QByteArray chunk = reply->readAll();
+    QMetaObject::invokeMethod(m_parser, [parser = m_parser, jobId, chunk]() {
+        parser->feedTasks(jobId, chunk);
+    }, Qt::QueuedConnection);
 }
 
 void TodoistClient::onTasksReplyFinished()
@@ -87,50 +428,59 @@ void TodoistClient::onTasksReplyFinished()
         return;
     }
 
-    // Check for network errors
-    if (reply->error() != QNetworkReply::NoError) {
-        QString errorMsg = handleNetworkError(reply);
-        qWarning() << "Tasks fetch failed:" << errorMsg;
-        emit errorOccurred(errorMsg);
-        reply->deleteLater();
-        return;
-    }
+    quint64 jobId = m_taskJobs.take(reply);
 
-    // Parse JSON response
-    QByteArray responseData = reply->readAll();
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(responseData, &parseError);
+    // Superseded or failed: stop parsing what arrived so far
+    bool current = finishRead(reply);
+    if (!current || reply->error() != QNetworkReply::NoError) {
+        m_jobGenerations.remove(jobId);
+        QMetaObject::invokeMethod(m_parser, [parser = m_parser, jobId]() {
+            parser->abortTasks(jobId);
+        }, Qt::QueuedConnection);
 
-    if (parseError.error != QJsonParseError::NoError) {
-        QString errorMsg = QString("Failed to parse tasks response: %1").arg(parseError.errorString());
-        qWarning() << errorMsg;
-        emit errorOccurred(errorMsg);
+        if (current) {
+            QString errorMsg = handleNetworkError(reply).message;
+            qWarning() << "Tasks fetch failed:" << errorMsg;
+            emit errorOccurred(errorMsg);
+        }
         reply->deleteLater();
         return;
     }
 
-    // Parse tasks array
-    QVector<Task> tasks;
-    QJsonArray tasksArray = doc.array();
+    // Hand over whatever arrived after the last readyRead, then close the stream
+    QByteArray chunk = reply->readAll();
+    QMetaObject::invokeMethod(m_parser, [parser = m_parser, jobId, chunk]() {
+        parser->feedTasks(jobId, chunk);
+        parser->finishTasks(jobId);
+    }, Qt::QueuedConnection);
 
-    for (const QJsonValue& value : tasksArray) {
-        if (value.isObject()) {
-            Task task = Task::fromJson(value.toObject());
+    // Critical: prevent memory leak
+    reply->deleteLater();
+}
 
-            // Look up project name from cache
-            if (!task.projectId.isEmpty() && m_projectNames.contains(task.projectId)) {
-                task.projectName = m_projectNames.value(task.projectId);
-            }
+void TodoistClient::onTasksParsed(quint64 jobId, const QVector<Task>& tasks)
+{
+    if (m_jobGenerations.value(jobId, m_readGeneration + 1) != m_readGeneration) {
+        return;  // Superseded refresh
+    }
+    emit tasksPartiallyFetched(tasks);
+}
 
-            tasks.append(task);
-        }
+void TodoistClient::onTasksFinished(quint64 jobId, const QVector<Task>& tasks, const QString& error)
+{
+    if (!finishJob(jobId)) {
+        qDebug() << "Dropping tasks from a superseded refresh";
+        return;
+    }
+
+    if (!error.isEmpty()) {
+        qWarning() << error;
+        emit errorOccurred(error);
+        return;
     }
 
     qDebug() << "Successfully fetched" << tasks.size() << "tasks";
     emit tasksFetched(tasks);
-
-    // Critical: prevent memory leak
-    reply->deleteLater();
 }
 
 void TodoistClient::onProjectsReplyFinished()
@@ -141,113 +491,144 @@ void TodoistClient::onProjectsReplyFinished()
         return;
     }
 
+    if (!finishRead(reply)) {
+        reply->deleteLater();
+        return;  // Superseded refresh
+    }
+
     // Check for network errors
     if (reply->error() != QNetworkReply::NoError) {
-        QString errorMsg = handleNetworkError(reply);
+        QString errorMsg = handleNetworkError(reply).message;
         qWarning() << "Projects fetch failed:" << errorMsg;
         emit errorOccurred(errorMsg);
         reply->deleteLater();
         return;
     }
 
-    // Parse JSON response
-    QByteArray responseData = reply->readAll();
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(responseData, &parseError);
+    // Parse on the worker thread
+    quint64 jobId = ++m_nextJobId;
+    m_jobGenerations.insert(jobId, m_readGeneration);
+    QByteArray body = reply->readAll();
+    QMetaObject::invokeMethod(m_parser, [parser = m_parser, jobId, body]() {
+        parser->parseProjects(jobId, body);
+    }, Qt::QueuedConnection);
 
-    if (parseError.error != QJsonParseError::NoError) {
-        QString errorMsg = QString("Failed to parse projects response: %1").arg(parseError.errorString());
-        qWarning() << errorMsg;
-        emit errorOccurred(errorMsg);
-        reply->deleteLater();
+    // Critical: prevent memory leak
+    reply->deleteLater();
+}
+
+void TodoistClient::onProjectsParsed(quint64 jobId, const QMap<QString, QString>& projects, const QString& error)
+{
+    if (!finishJob(jobId)) {
+        qDebug() << "Dropping projects from a superseded refresh";
         return;
     }
 
-    // Parse projects array and update cache
-    m_projectNames.clear();
-    QJsonArray projectsArray = doc.array();
-
-    for (const QJsonValue& value : projectsArray) {
-        if (value.isObject()) {
-            QJsonObject projectObj = value.toObject();
-            QString id = projectObj["id"].toString();
-            QString name = projectObj["name"].toString();
-
-            if (!id.isEmpty()) {
-                m_projectNames.insert(id, name);
-            }
-        }
+    if (!error.isEmpty()) {
+        qWarning() << error;
+        emit errorOccurred(error);
+        return;
     }
 
+    m_projectNames = projects;
     qDebug() << "Successfully fetched" << m_projectNames.size() << "projects";
     emit projectsFetched(m_projectNames);
-
-    // Critical: prevent memory leak
-    reply->deleteLater();
 }
 
-void TodoistClient::onCloseTaskReplyFinished()
+void TodoistClient::onSyncReplyFinished()
 {
     QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
     if (!reply) {
-        qWarning() << "onCloseTaskReplyFinished called with invalid sender";
+        qWarning() << "onSyncReplyFinished called with invalid sender";
         return;
     }
 
-    // Extract task ID from URL (e.g., https://api.todoist.com/rest/v2/tasks/12345/close)
-    QString url = reply->url().toString();
-    QString taskId = url.section('/', -2, -2);  // Extract ID from path
+    if (!finishRead(reply)) {
+        reply->deleteLater();
+        return;  // Superseded refresh
+    }
+
+    QString sentToken = reply->property("syncToken").toString();
 
     // Check for network errors
     if (reply->error() != QNetworkReply::NoError) {
-        QString errorMsg = handleNetworkError(reply);
-        qWarning() << "Close task" << taskId << "failed:" << errorMsg;
-        emit closeTaskFailed(taskId, errorMsg);
+        int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+        // A stale or unknown token is rejected with a 4xx; auth and rate limit errors are not token problems
+        bool tokenRejected = sentToken != "*" && statusCode >= 400 && statusCode < 500 &&
+                             statusCode != 401 && statusCode != 403 && statusCode != 429;
+        if (tokenRejected) {
+            qWarning() << "Sync token rejected with status" << statusCode << "- falling back to full sync";
+            emit syncTokenInvalid();
+            reply->deleteLater();
+            return;
+        }
+
+        QString errorMsg = handleNetworkError(reply).message;
+        qWarning() << "Sync failed:" << errorMsg;
+        emit errorOccurred(errorMsg);
         reply->deleteLater();
         return;
     }
 
-    // Check for 204 No Content status code (success)
-    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-    if (statusCode == 204) {
-        qDebug() << "Successfully closed task" << taskId;
-        emit taskClosed(taskId);
-    } else {
-        QString errorMsg = QString("Unexpected status code: %1").arg(statusCode);
-        qWarning() << "Close task" << taskId << "failed:" << errorMsg;
-        emit closeTaskFailed(taskId, errorMsg);
-    }
+    // Parse on the worker thread
+    quint64 jobId = ++m_nextJobId;
+    m_jobGenerations.insert(jobId, m_readGeneration);
+    QByteArray body = reply->readAll();
+    bool requestedFullSync = (sentToken == "*");
+    QMetaObject::invokeMethod(m_parser, [parser = m_parser, jobId, body, requestedFullSync]() {
+        parser->parseSync(jobId, body, requestedFullSync);
+    }, Qt::QueuedConnection);
 
     // Critical: prevent memory leak
     reply->deleteLater();
 }
 
-void TodoistClient::onCreateTaskReplyFinished()
+void TodoistClient::onSyncParsed(quint64 jobId, const SyncDelta& delta, const QString& error)
+{
+    if (!finishJob(jobId)) {
+        qDebug() << "Dropping sync result from a superseded refresh";
+        return;
+    }
+
+    if (!error.isEmpty()) {
+        qWarning() << error;
+        emit errorOccurred(error);
+        return;
+    }
+
+    m_projectNames = delta.projectNames;
+
+    qDebug() << "Sync complete, full:" << delta.fullSync
+             << "changed:" << delta.tasks.size() << "removed:" << delta.removedTaskIds.size();
+    emit deltaFetched(delta);
+}
+
+void TodoistClient::onCommandsReplyFinished()
 {
     QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
     if (!reply) {
-        qWarning() << "onCreateTaskReplyFinished called with invalid sender";
+        qWarning() << "onCommandsReplyFinished called with invalid sender";
         return;
     }
 
-    // Extract content from request body for signal parameter
-    QByteArray requestData = reply->request().attribute(QNetworkRequest::CustomVerbAttribute).toByteArray();
-    QJsonDocument requestDoc = QJsonDocument::fromJson(reply->request().attribute(QNetworkRequest::User).toByteArray());
-    QString content;
+    QString requestId = reply->property("requestId").toString();
+    QVector<SyncOperation> operations = m_commandBatches.take(reply);
+    QStringList uuids;
+    for (const SyncOperation& op : operations) {
+        uuids.append(op.uuid);
+    }
 
-    // Check for network errors
+    // Check for network errors (the whole batch failed, nothing was applied)
     if (reply->error() != QNetworkReply::NoError) {
-        QString errorMsg = handleNetworkError(reply);
-        qWarning() << "Create task failed:" << errorMsg;
-
-        // Try to extract content from reply readAll (in case of server response)
-        QByteArray responseData = reply->readAll();
-        QJsonDocument doc = QJsonDocument::fromJson(responseData);
-        if (doc.isObject() && doc.object().contains("content")) {
-            content = doc.object()["content"].toString();
+        NetworkError error = handleNetworkError(reply);
+        qWarning() << "Command batch failed:" << error.message;
+        if (error.category == NetworkError::RateLimited) {
+            qint64 pauseMs = error.retryAfterMs >= 0 ? error.retryAfterMs : DEFAULT_RETRY_AFTER_MS;
+            qDebug() << "Rate limited, pausing command requests for" << pauseMs << "ms";
+            m_rateLimiter.pauseFor(pauseMs);
         }
-
-        emit createTaskFailed(content, errorMsg);
+        emit commandsFailed(requestId, uuids, error);
         reply->deleteLater();
         return;
     }
@@ -257,59 +638,95 @@ void TodoistClient::onCreateTaskReplyFinished()
     QJsonParseError parseError;
     QJsonDocument doc = QJsonDocument::fromJson(responseData, &parseError);
 
-    if (parseError.error != QJsonParseError::NoError) {
-        QString errorMsg = QString("Failed to parse create task response: %1").arg(parseError.errorString());
-        qWarning() << errorMsg;
-        emit createTaskFailed(content, errorMsg);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        NetworkError error = NetworkError::badResponse(
+            QString("Failed to parse command response: %1").arg(parseError.errorString()));
+        qWarning() << error.message;
+        emit commandsFailed(requestId, uuids, error);
         reply->deleteLater();
         return;
     }
 
-    // Check for HTTP 200 status code (Todoist API returns 200, not 201)
-    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-    if (statusCode == 200 && doc.isObject()) {
-        QJsonObject taskObj = doc.object();
-        QString newTaskId = taskObj["id"].toString();
-        content = taskObj["content"].toString();
-
-        qDebug() << "Successfully created task:" << content << "id:" << newTaskId;
-        emit taskCreated(content, newTaskId);
-    } else {
-        QString errorMsg = QString("Unexpected status code: %1").arg(statusCode);
-        qWarning() << "Create task failed:" << errorMsg;
-        if (doc.isObject() && doc.object().contains("content")) {
-            content = doc.object()["content"].toString();
+    QJsonObject root = doc.object();
+    QJsonObject syncStatus = root["sync_status"].toObject();
+    QJsonObject tempIdMapping = root["temp_id_mapping"].toObject();
+
+    // Demultiplex per-command status back onto the queued operations
+    QVector<CommandResult> results;
+    results.reserve(operations.size());
+    for (const SyncOperation& op : operations) {
+        CommandResult result;
+        result.uuid = op.uuid;
+        result.ok = commandSucceeded(syncStatus.value(op.uuid), &result.error, &result.retryable);
+
+        if (result.ok && op.type == "create_task") {
+            result.serverId = tempIdMapping.value(op.tempId).toString();
+
+            // A create-as-completed only succeeds once both halves have
+            if (op.closeAfterCreate) {
+                result.ok = commandSucceeded(syncStatus.value(closeCommandUuid(op)), &result.error,
+                                             &result.retryable);
+            }
         }
-        emit createTaskFailed(content, errorMsg);
+
+        results.append(result);
     }
 
+    qDebug() << "Command batch" << requestId << "complete:" << results.size() << "results";
+    emit commandsCompleted(requestId, results);
+
     // Critical: prevent memory leak
     reply->deleteLater();
 }
 
-QString TodoistClient::handleNetworkError(QNetworkReply* reply)
+void TodoistClient::probeConnectivity()
 {
-    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (m_probeReply) {
+        return;  // One at a time; its result answers every caller
+    }
 
-    switch (statusCode) {
-        case 401:
-            return "Invalid API token. Please check your token in settings.";
-        case 403:
-            return "Access forbidden. Your token may not have the required permissions.";
-        case 404:
-            return "API endpoint not found. The Todoist API may have changed.";
-        case 429:
-            return "Too many requests. Please wait a moment and try again.";
-        case 500:
-        case 502:
-        case 503:
-        case 504:
-            return "Todoist server error. Please try again later.";
-        default:
-            if (reply->error() == QNetworkReply::NoError) {
-                return QString();  // No error
-            }
-            // Network-level errors (no connection, timeout, etc.)
-            return QString("Network error: %1").arg(reply->errorString());
+    QNetworkRequest request(apiUrl("/"));
+    request.setTransferTimeout(PROBE_TIMEOUT_MS);
+
+    m_probeReply = m_networkManager->head(request);
+    m_probeReply->setProperty("sentAt", m_clock.elapsed());
+    m_lastConnectionUseMs = m_clock.elapsed();
+    connect(m_probeReply, &QNetworkReply::finished, this, &TodoistClient::onProbeReplyFinished);
+}
+
+void TodoistClient::onProbeReplyFinished()
+{
+    QNetworkReply* reply = m_probeReply;
+    m_probeReply = nullptr;
+    if (!reply) {
+        return;
+    }
+
+    // Any status at all means the host answered; only transport errors mean unreachable
+    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    bool reachable = statusCode > 0;
+    qint64 rttMs = -1;
+
+    if (reachable) {
+        // Not fed to the request timeout estimate: a HEAD answers far faster
+        // than a sync, and a run of probes would shrink the timeout until
+        // real requests are cut off
+        rttMs = m_clock.elapsed() - reply->property("sentAt").toLongLong();
+        qDebug() << "Connectivity probe: reachable in" << rttMs << "ms";
+    } else {
+        NetworkError error = NetworkError::fromReply(reply);
+        qDebug() << "Connectivity probe failed:" << NetworkError::categoryName(error.category)
+                 << "-" << reply->errorString();
     }
+
+    emit connectivityProbed(reachable, rttMs);
+    reply->deleteLater();
+}
+
+NetworkError TodoistClient::handleNetworkError(QNetworkReply* reply)
+{
+    NetworkError error = NetworkError::fromReply(reply);
+    qDebug() << "Request failed:" << NetworkError::categoryName(error.category)
+             << "status" << error.httpStatus << "-" << reply->errorString();
+    return error;
 }
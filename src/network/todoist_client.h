@@ -6,7 +6,30 @@
 #include <QNetworkReply>
 #include <QVector>
 #include <QMap>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <QElapsedTimer>
 #include "../models/task.h"
+#include "../models/sync_queue.h"
+#include "task_parser.h"
+#include "network_error.h"
+#include "token_bucket.h"
+
+class QThread;
+
+/**
+ * @brief Outcome of one command inside a batched Sync API request.
+ */
+struct CommandResult {
+    QString uuid;      // SyncOperation::uuid the command was sent with
+    bool ok;           // Server reported "ok" in sync_status
+    bool retryable;    // When !ok: rate limited, a server-side failure or no status at all
+    QString error;     // Server error message when !ok
+    QString serverId;  // Real task ID for create_task (from temp_id_mapping)
+
+    CommandResult() : ok(false), retryable(false) {}
+};
 
 /**
  * @brief TodoistClient provides async access to the Todoist REST API v2.
@@ -18,8 +41,12 @@
  *   TodoistClient* client = new TodoistClient(apiToken, this);
  *   connect(client, &TodoistClient::tasksFetched, this, &MyClass::onTasks);
  *   connect(client, &TodoistClient::errorOccurred, this, &MyClass::onError);
- *   client->fetchProjects();  // Fetch projects first to get names
- *   client->fetchAllTasks();  // Then fetch tasks
+ *   client->fetchProjects();  // Both requests may run concurrently; if tasks
+ *   client->fetchAllTasks();  // land first, re-apply names from projectsFetched()
+ *
+ * Incremental refreshes go through the Sync API instead:
+ *   connect(client, &TodoistClient::deltaFetched, this, &MyClass::onDelta);
+ *   client->syncResources(storedToken);  // "*" for a full sync
  */
 class TodoistClient : public QObject
 {
@@ -32,12 +59,31 @@ public:
      * @param parent Parent QObject for memory management
      */
     explicit TodoistClient(const QString& apiToken, QObject* parent = nullptr);
+    ~TodoistClient();
+
+    /**
+     * @brief Override the API base URL (default https://api.todoist.com)
+     * @param baseUrl Scheme and host, e.g. http://127.0.0.1:8765 for the mock server
+     */
+    void setApiBaseUrl(const QString& baseUrl);
+
+    /**
+     * @brief Seed the project name cache, e.g. from a saved snapshot
+     * @param projectNames projectId -> projectName
+     *
+     * Delta syncs only send changed projects, so without this tasks from
+     * the first delta after a restart would have no project names.
+     */
+    void setProjectNames(const QMap<QString, QString>& projectNames);
 
     /**
      * @brief Fetch all tasks from Todoist
      *
-     * Emits tasksFetched() on success or errorOccurred() on failure.
-     * Tasks will have projectName populated from cached project data.
+     * The body is parsed incrementally: tasksPartiallyFetched() is emitted
+     * as array elements complete, then tasksFetched() with the full list on
+     * success or errorOccurred() on failure.
+     * Tasks have projectName populated from cached project data; if the
+     * projects request has not completed yet, names are left empty.
      */
     void fetchAllTasks();
 
@@ -50,20 +96,79 @@ public:
     void fetchProjects();
 
     /**
-     * @brief Close (complete) a task in Todoist
-     * @param taskId The ID of the task to close
+     * @brief Fetch tasks and projects changed since a previous sync
+     * @param syncToken Token from the previous SyncDelta, or "*" for everything
      *
-     * Emits taskClosed() on success or closeTaskFailed() on failure.
+     * Emits deltaFetched() on success. If the server rejects the token,
+     * emits syncTokenInvalid() so the caller can fall back to a full sync.
+     * Other failures emit errorOccurred().
      */
-    void closeTask(const QString& taskId);
+    void syncResources(const QString& syncToken);
 
     /**
-     * @brief Create a new task in Todoist
-     * @param content The task name/content
+     * @brief Submit queued operations as one batched Sync API request
+     * @param operations close_task/create_task operations, applied by the server in order
+     *
+     * Each operation's uuid is sent as the command uuid (so replays are
+     * idempotent) and create_task uses its tempId as the command temp_id.
+     * Emits commandsCompleted() with one result per operation, or
+     * commandsFailed() if the request as a whole failed.
      *
-     * Emits taskCreated() on success or createTaskFailed() on failure.
+     * @return Correlation ID passed back with the result signal, so several
+     *         batches can be in flight at once
      */
-    void createTask(const QString& content);
+    QString submitCommands(const QVector<SyncOperation>& operations);
+
+    /**
+     * @brief Reserve a slot under the client-side rate limit
+     * @param waitMs Set to the delay before a slot frees up when false is returned
+     * @param interactive Fresh user action: may use the slots held back from bulk traffic
+     *
+     * Call before each submitCommands() during a backlog drain. The limit
+     * stays under Todoist's request quota, and a 429's Retry-After pauses
+     * it, so bulk syncs slow down instead of being rejected.
+     */
+    bool tryAcquireRequest(qint64* waitMs, bool interactive = false);
+
+    /**
+     * @brief Check whether the API host answers at all
+     *
+     * Sends an unauthenticated HEAD request with a short timeout; any HTTP
+     * response counts as reachable. Emits connectivityProbed(). Only one
+     * probe runs at a time.
+     */
+    void probeConnectivity();
+
+    /**
+     * @brief Open a connection to the API host ahead of the next request
+     *
+     * DNS, TCP and TLS handshakes on a cold connection cost several round
+     * trips; doing them while the user is still typing (or while the
+     * network is just coming back) takes them off the request's latency.
+     * A no-op if a request used the connection in the last 30 seconds.
+     */
+    void warmUp();
+
+    /**
+     * @brief Abort every in-flight read (tasks, projects, sync)
+     *
+     * Used when a newer refresh supersedes the one in progress. Aborted
+     * replies finish without errorOccurred(), and results from their
+     * parser jobs are dropped, so nothing from the old refresh reaches
+     * the model after this returns. Task creation and command batches
+     * are left alone.
+     */
+    void cancelReads();
+
+    /**
+     * @brief Transfer timeout currently applied to new requests
+     *
+     * Derived from measured API response times (smoothed RTT plus four
+     * times its variance, as for TCP retransmission), so a slow or flaky
+     * link fails fast instead of waiting out a fixed 30 seconds.
+     * Connectivity probes are not sampled.
+     */
+    int requestTimeout() const;
 
 signals:
     /**
@@ -72,6 +177,12 @@ signals:
      */
     void tasksFetched(const QVector<Task>& tasks);
 
+    /**
+     * @brief Emitted while the tasks response is still downloading
+     * @param tasks Tasks parsed from the latest chunk (a slice of the final list)
+     */
+    void tasksPartiallyFetched(const QVector<Task>& tasks);
+
     /**
      * @brief Emitted when projects have been successfully fetched
      * @param projects Map of project ID to project name
@@ -79,50 +190,95 @@ signals:
     void projectsFetched(const QMap<QString, QString>& projects);
 
     /**
-     * @brief Emitted when an error occurs during API request
-     * @param error User-friendly error message
+     * @brief Emitted when a Sync API request has completed
+     * @param delta Changed tasks, removed task IDs and the next sync token
      */
-    void errorOccurred(const QString& error);
+    void deltaFetched(const SyncDelta& delta);
 
     /**
-     * @brief Emitted when a task has been successfully closed
-     * @param taskId The ID of the closed task
+     * @brief Emitted when the server no longer accepts a stored sync token
+     *
+     * The caller should discard the token and request a full sync with "*".
      */
-    void taskClosed(const QString& taskId);
+    void syncTokenInvalid();
 
     /**
-     * @brief Emitted when closing a task fails
-     * @param taskId The ID of the task that failed to close
+     * @brief Emitted when an error occurs during API request
      * @param error User-friendly error message
      */
-    void closeTaskFailed(const QString& taskId, const QString& error);
+    void errorOccurred(const QString& error);
 
     /**
-     * @brief Emitted when a task has been successfully created
-     * @param content The content of the created task
-     * @param newTaskId The server-assigned task ID
+     * @brief Emitted when a batched command request has been answered
+     * @param requestId Correlation ID returned by submitCommands()
+     * @param results Per-operation status, in submission order
      */
-    void taskCreated(const QString& content, const QString& newTaskId);
+    void commandsCompleted(const QString& requestId, const QVector<CommandResult>& results);
 
     /**
-     * @brief Emitted when creating a task fails
-     * @param content The content of the task that failed to create
+     * @brief Emitted when a batched command request failed entirely
+     * @param requestId Correlation ID returned by submitCommands()
+     * @param uuids Operation uuids that were in the request
      * @param error User-friendly error message
      */
-    void createTaskFailed(const QString& content, const QString& error);
+    void commandsFailed(const QString& requestId, const QStringList& uuids, const NetworkError& error);
+
+    /**
+     * @brief Emitted when a connectivity probe has finished
+     * @param reachable Whether the server sent any HTTP response
+     * @param rttMs Round trip time of the probe (-1 if unreachable)
+     */
+    void connectivityProbed(bool reachable, qint64 rttMs);
 
 private slots:
+    void onTasksReadyRead();
     void onTasksReplyFinished();
+    void onTasksParsed(quint64 jobId, const QVector<Task>& tasks);
+    void onTasksFinished(quint64 jobId, const QVector<Task>& tasks, const QString& error);
+    void onProjectsParsed(quint64 jobId, const QMap<QString, QString>& projects, const QString& error);
+    void onSyncParsed(quint64 jobId, const SyncDelta& delta, const QString& error);
     void onProjectsReplyFinished();
-    void onCloseTaskReplyFinished();
-    void onCreateTaskReplyFinished();
+    void onSyncReplyFinished();
+    void onCommandsReplyFinished();
+    void onProbeReplyFinished();
 
 private:
-    QString handleNetworkError(QNetworkReply* reply);
+    NetworkError handleNetworkError(QNetworkReply* reply);
+    void trackLatency(QNetworkReply* reply);  // Sample response time and time each phase
+    void logTiming(QNetworkReply* reply);     // Handshake vs server vs transfer time
+    void recordRtt(qint64 rttMs);
+    void trackRead(QNetworkReply* reply);   // Tag a read with the current generation
+    bool finishRead(QNetworkReply* reply);  // False if the read was superseded
+    bool finishJob(quint64 jobId);          // False if the parser job was superseded
+    QUrl apiUrl(const QString& path) const;
+    QNetworkRequest authorizedRequest(const QString& path, const QString& requestId = QString()) const;
+    static QString newRequestId();
 
     QNetworkAccessManager* m_networkManager;
     QString m_apiToken;
+    QString m_baseUrl;
     QMap<QString, QString> m_projectNames;  // projectId -> projectName cache
+    QHash<QNetworkReply*, QVector<SyncOperation>> m_commandBatches;  // In-flight command requests
+
+    // Parsing happens on m_parserThread; jobs are correlated by ID
+    QThread* m_parserThread;
+    TaskParser* m_parser;
+    quint64 m_nextJobId;
+    QHash<QNetworkReply*, quint64> m_taskJobs;  // Tasks downloads -> parser job
+
+    // Reads belong to the generation they started in; cancelReads() bumps it
+    quint64 m_readGeneration;
+    QSet<QNetworkReply*> m_readReplies;          // In-flight reads
+    QHash<quint64, quint64> m_jobGenerations;    // Parser job -> generation
+
+    // Response time estimate for the adaptive timeout (-1 until sampled)
+    QElapsedTimer m_clock;
+    qint64 m_srttMs;
+    qint64 m_rttVarMs;
+    QNetworkReply* m_probeReply;  // Probe in progress, or null
+    qint64 m_lastConnectionUseMs; // m_clock time of the last request or warm-up
+
+    TokenBucket m_rateLimiter;  // Command submissions
 };
 
 #endif // TODOIST_CLIENT_H
@@ -0,0 +1,51 @@
+#include "token_bucket.h"
+#include <QtMath>
+
+TokenBucket::TokenBucket(double capacity, double ratePerSecond)
+    : m_capacity(capacity)
+    , m_ratePerMs(ratePerSecond / 1000.0)
+    , m_tokens(capacity)
+    , m_lastRefillMs(0)
+    , m_pausedUntilMs(0)
+{
+    m_clock.start();
+}
+
+void TokenBucket::refill(qint64 now)
+{
+    m_tokens = qMin(m_capacity, m_tokens + (now - m_lastRefillMs) * m_ratePerMs);
+    m_lastRefillMs = now;
+}
+
+bool TokenBucket::tryAcquire(qint64* waitMs, int reserve)
+{
+    qint64 now = m_clock.elapsed();
+    if (now < m_pausedUntilMs) {
+        if (waitMs) {
+            *waitMs = m_pausedUntilMs - now;
+        }
+        return false;
+    }
+
+    refill(now);
+    double needed = 1.0 + reserve;
+    if (m_tokens >= needed) {
+        m_tokens -= 1.0;
+        return true;
+    }
+
+    if (waitMs) {
+        *waitMs = static_cast<qint64>(qCeil((needed - m_tokens) / m_ratePerMs));
+    }
+    return false;
+}
+
+void TokenBucket::pauseFor(qint64 ms)
+{
+    qint64 now = m_clock.elapsed();
+    m_pausedUntilMs = qMax(m_pausedUntilMs, now + ms);
+
+    // Start from empty afterwards so the backlog doesn't burst straight back in
+    m_tokens = 0;
+    m_lastRefillMs = m_pausedUntilMs;
+}
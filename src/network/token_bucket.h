@@ -0,0 +1,40 @@
+#ifndef TOKEN_BUCKET_H
+#define TOKEN_BUCKET_H
+
+#include <QElapsedTimer>
+
+/**
+ * @brief Client-side rate limiter.
+ *
+ * Holds up to capacity tokens, refilled continuously at ratePerSecond.
+ * Each request takes one token; when none is left the caller is told how
+ * long to wait instead of sending a request the server would reject.
+ * pauseFor() empties the bucket for a while, e.g. to honour Retry-After.
+ */
+class TokenBucket
+{
+public:
+    TokenBucket(double capacity, double ratePerSecond);
+
+    /**
+     * @brief Take a token if one is available
+     * @param waitMs Set to the delay until a token is available when false is returned
+     * @param reserve Tokens that must remain afterwards (kept for higher-priority callers)
+     */
+    bool tryAcquire(qint64* waitMs = nullptr, int reserve = 0);
+
+    // Hand out nothing for the next ms milliseconds
+    void pauseFor(qint64 ms);
+
+private:
+    void refill(qint64 now);
+
+    double m_capacity;
+    double m_ratePerMs;
+    double m_tokens;
+    QElapsedTimer m_clock;
+    qint64 m_lastRefillMs;
+    qint64 m_pausedUntilMs;
+};
+
+#endif // TOKEN_BUCKET_H